@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Versioned C interface for robots. Every tick the engine fills an observation, the robot writes a
+ * command, and neither side needs the other's compiler, standard library or allocator
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CROBOTS_ABI_VERSION 1
+#define CROBOTS_CREATE "crobots_create"
+
+#if defined(_WIN32)
+#define CROBOTS_EXPORT __declspec(dllexport)
+#elif defined(__GNUC__) || defined(__clang__)
+#define CROBOTS_EXPORT __attribute__((visibility("default")))
+#else
+#define CROBOTS_EXPORT
+#endif
+
+#ifdef __cplusplus
+#define CROBOTS_ALIGN(n) alignas(n)
+#else
+#define CROBOTS_ALIGN(n) _Alignas(n)
+#endif
+
+/* observation flags */
+#define CROBOTS_SCAN_FOUND 1u
+
+/* command flags */
+#define CROBOTS_COMMAND_FIRE 1u
+#define CROBOTS_COMMAND_SCAN 2u
+#define CROBOTS_COMMAND_COOL_DOWN 4u
+
+/* filled by the engine before every update, one cache line */
+typedef struct crobots_observation
+{
+    CROBOTS_ALIGN(64) uint32_t version;
+    uint32_t flags;
+    uint64_t tick;
+    float delta_time;
+    /* seconds */
+    float time;
+    /* meters */
+    float x;
+    float y;
+    /* meters/second, as last commanded */
+    float speed;
+    float damage;
+    float heat;
+    /* meters to whatever the previous tick's scan found, if CROBOTS_SCAN_FOUND is set */
+    float scan_distance;
+    uint8_t reserved[16];
+} crobots_observation;
+
+/* starts every tick with the current speed and no flags, so robots only write what they change */
+typedef struct crobots_command
+{
+    CROBOTS_ALIGN(64) float speed;
+    uint32_t flags;
+    float fire_angle;
+    float fire_range;
+    float scan_angle;
+    float scan_width;
+    uint8_t reserved[40];
+} crobots_command;
+
+/* services the engine offers a robot for as long as it lives */
+typedef struct crobots_host
+{
+    void* context;
+    /* declares a tunable constant on first use and returns its current value, clamped to [min, max] */
+    float (*get_parameter)(void* context, const char* name, float value, float min, float max);
+} crobots_host;
+
+typedef struct crobots_robot
+{
+    void* instance;
+    void (*update)(void* instance, const crobots_observation* observation, crobots_command* command);
+    void (*destroy)(void* instance);
+} crobots_robot;
+
+/* exported as CROBOTS_CREATE. returns 0 if the robot couldn't be created or doesn't speak the version */
+typedef int (*crobots_create_function)(uint32_t version, const crobots_host* host, crobots_robot* robot);
+
+#ifdef __cplusplus
+}
+
+static_assert(sizeof(crobots_observation) == 64, "Observations are one cache line");
+static_assert(sizeof(crobots_command) == 64, "Commands are one cache line");
+#endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "abi.h"
+
+#define CROBOTS_ABI_ROBOT(T) \
+    extern "C" CROBOTS_EXPORT int crobots_create(uint32_t version, const crobots_host* host, crobots_robot* robot) \
+    { \
+        return crobots::AbiRobot::Create<T>(version, host, robot); \
+    } \
+
+namespace crobots
+{
+
+/**
+ * Header only counterpart of IRobot for robots built against the C interface. Accessors read the
+ * observation and write the command directly, so they inline and never cross into the engine
+ */
+class AbiRobot
+{
+protected:
+    AbiRobot()
+        : Host{}
+        , Observation{nullptr}
+        , Command{nullptr}
+    {
+    }
+
+public:
+    template<typename T>
+    static int Create(uint32_t version, const crobots_host* host, crobots_robot* robot)
+    {
+        if (version != CROBOTS_ABI_VERSION)
+        {
+            return 0;
+        }
+        T* instance = new (std::nothrow) T();
+        if (!instance)
+        {
+            return 0;
+        }
+        AbiRobot* base = instance;
+        base->Host = *host;
+        robot->instance = base;
+        robot->update = [](void* instance, const crobots_observation* observation, crobots_command* command)
+        {
+            AbiRobot* robot = static_cast<AbiRobot*>(instance);
+            robot->Observation = observation;
+            robot->Command = command;
+            robot->Update(observation->delta_time);
+        };
+        robot->destroy = [](void* instance)
+        {
+            delete static_cast<AbiRobot*>(instance);
+        };
+        return 1;
+    }
+
+    AbiRobot(const AbiRobot& other) = delete;
+    AbiRobot& operator=(const AbiRobot& other) = delete;
+    virtual ~AbiRobot() = default;
+    virtual void Update(float deltaTime) = 0;
+
+    void SetSpeed(float speed)
+    {
+        Command->speed = speed;
+    }
+
+    // meters/second
+    float GetSpeed() const
+    {
+        return Observation->speed;
+    }
+
+    // meters
+    float GetX() const
+    {
+        return Observation->x;
+    }
+
+    // meters
+    float GetY() const
+    {
+        return Observation->y;
+    }
+
+    void Fire(float angle, float range)
+    {
+        Command->flags |= CROBOTS_COMMAND_FIRE;
+        Command->fire_angle = angle;
+        Command->fire_range = range;
+    }
+
+    // the result arrives with the next tick's observation, see GetScan
+    void Scan(float angle, float width)
+    {
+        Command->flags |= CROBOTS_COMMAND_SCAN;
+        Command->scan_angle = angle;
+        Command->scan_width = width;
+    }
+
+    std::optional<float> GetScan() const
+    {
+        if (Observation->flags & CROBOTS_SCAN_FOUND)
+        {
+            return Observation->scan_distance;
+        }
+        return {};
+    }
+
+    float GetHeat() const
+    {
+        return Observation->heat;
+    }
+
+    void CoolDown()
+    {
+        Command->flags |= CROBOTS_COMMAND_COOL_DOWN;
+    }
+
+    float GetDamage() const
+    {
+        return Observation->damage;
+    }
+
+    float GetTime() const
+    {
+        return Observation->time;
+    }
+
+    uint64_t GetTick() const
+    {
+        return Observation->tick;
+    }
+
+    /**
+     * Declares a tunable constant on first use and returns its current value.
+     * Unlike the accessors this calls into the engine, so read it once and keep it
+     */
+    float GetParameter(const std::string_view& name, float value, float min, float max)
+    {
+        std::string terminated{name};
+        return Host.get_parameter(Host.context, terminated.data(), value, min, max);
+    }
+
+private:
+    crobots_host Host;
+    const crobots_observation* Observation;
+    crobots_command* Command;
+};
+
+}
\ No newline at end of file
@@ -1,8 +1,34 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
+#include "robot.hpp"
+
 namespace crobots
 {
 
+static constexpr int kOutboxSize = 4;
+// room for every teammate filling its outbox
+static constexpr int kInboxSize = 32;
+static constexpr int kBroadcast = -1;
+// one per other robot in the largest lineup
+static constexpr int kMaxSightings = 8;
+
+struct Parameter
+{
+    std::string Name;
+    float Value;
+    float Min;
+    float Max;
+};
+
+struct Sighting
+{
+    float X;
+    float Y;
+};
+
 class RobotContext
 {
 public:
@@ -11,6 +37,19 @@ public:
         , Y{0.0f}
         , Speed{0.0f}
         , Acceleration{1.0f}
+        , Damage{0.0f}
+        , Time{0.0f}
+        , Parameters{}
+        , Overrides{}
+        , Index{0}
+        , Team{-1}
+        , Outbox{}
+        , Recipients{}
+        , Outgoing{0}
+        , Inbox{}
+        , Incoming{0}
+        , Sightings{}
+        , Visible{0}
     {
     }
 
@@ -18,6 +57,27 @@ public:
     float Y;
     float Speed;
     float Acceleration;
+    float Damage;
+    float Time;
+    // declared by the robot the first time it asks for them
+    std::vector<Parameter> Parameters;
+    // set by the engine before the first tick. min and max are ignored
+    std::vector<Parameter> Overrides;
+    int Index;
+    // only teammates hear each other, -1 is a team of one
+    int Team;
+    // written by the robot during its update and emptied by the engine once every robot has updated, so
+    // no two threads ever touch the same mailbox and delivery doesn't depend on update order
+    Message Outbox[kOutboxSize];
+    // lineup slot or kBroadcast
+    int Recipients[kOutboxSize];
+    int Outgoing;
+    // what teammates sent last tick, refilled by the engine between updates
+    Message Inbox[kInboxSize];
+    int Incoming;
+    // robots in line of sight as the tick started, refreshed by the engine before every update
+    Sighting Sightings[kMaxSightings];
+    int Visible;
 };
 
 }
\ No newline at end of file
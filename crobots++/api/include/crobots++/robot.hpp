@@ -1,7 +1,12 @@
 #pragma once
 
+#include <coroutine>
+#include <cstddef>
 #include <memory>
 #include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
 
 #if defined(_WIN32)
 #define CROBOTS_ENTRYPOINT extern "C" __declspec(dllexport)
@@ -20,6 +25,14 @@
 namespace crobots
 {
 
+// fixed size so sending never allocates. what the data means is up to the team
+struct Message
+{
+    // lineup slot of the robot that sent it, filled in on delivery
+    int Sender;
+    float Data[7];
+};
+
 class RobotContext;
 class IRobot
 {
@@ -39,7 +52,7 @@ public:
     IRobot& operator=(const IRobot& other) = delete;
     IRobot(IRobot&& other) = delete;
     IRobot& operator=(IRobot&& other) = delete;
-    ~IRobot() = default;
+    virtual ~IRobot() = default;
     virtual void Update(float deltaTime) = 0;
     
     /**
@@ -58,6 +71,10 @@ public:
 
     void Fire(float angle, float range);
 
+    /**
+     * Meters to the nearest robot in line of sight within width / 2 of angle, if there is one.
+     * Radians, counterclockwise from the x axis
+     */
     std::optional<float> Scan(float angle, float width);
 
     float GetHeat();
@@ -68,8 +85,213 @@ public:
 
     float GetTime();
 
+    /**
+     * Declares a tunable constant on first use and returns its current value.
+     * Returns value unless a tuning harness overrides it, clamped to [min, max]
+     */
+    float GetParameter(const std::string_view& name, float value, float min, float max);
+
+    // lineup slot, the same for the whole match
+    int GetIndex();
+
+    // -1 if the robot has no teammates
+    int GetTeam();
+
+    /**
+     * Queues a message for the teammate in the given lineup slot, received on its next update.
+     * Returns false once 4 messages have been queued this tick. Messages to other teams are dropped
+     */
+    bool Send(int robot, const Message& message);
+
+    // as Send, for every teammate
+    bool Broadcast(const Message& message);
+
+    // what teammates sent last tick, in lineup order. valid until the next update
+    std::span<const Message> Receive();
+
 private:
     std::shared_ptr<RobotContext> Context;
 };
 
+/**
+ * Hands out coroutine frames from chunks owned by one robot. Freed frames go back on a free list per
+ * size class, so a robot that keeps calling the same coroutines stops touching the heap after warming up
+ */
+class FramePool
+{
+public:
+    FramePool();
+    FramePool(const FramePool& other) = delete;
+    FramePool& operator=(const FramePool& other) = delete;
+    ~FramePool();
+
+    // nullptr if size is bigger than the largest class
+    void* Allocate(std::size_t size);
+    void Deallocate(void* pointer, std::size_t size);
+
+private:
+    static constexpr int kClasses = 7;
+    static constexpr std::size_t kChunkSize = 16384;
+
+    struct Block
+    {
+        Block* Next;
+    };
+
+    std::vector<void*> Chunks;
+    Block* Free[kClasses];
+    std::byte* Cursor;
+    std::size_t Remaining;
+};
+
+/**
+ * Return type of every CoRobot coroutine. Tasks start suspended, run when awaited and resume whoever
+ * awaited them when they return, so sub-routines nest like ordinary calls
+ */
+class Task
+{
+public:
+    class promise_type
+    {
+    public:
+        promise_type();
+        Task get_return_object();
+        std::suspend_always initial_suspend() noexcept;
+        auto final_suspend() noexcept
+        {
+            struct Awaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    std::coroutine_handle<> parent = handle.promise().Parent;
+                    return parent ? parent : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept
+                {
+                }
+            };
+            return Awaiter{};
+        }
+        void return_void();
+        void unhandled_exception();
+
+        // frames come from the pool of the robot being updated, if there is one
+        static void* operator new(std::size_t size);
+        static void operator delete(void* pointer, std::size_t size);
+
+    private:
+        friend class Task;
+
+        std::coroutine_handle<> Parent;
+    };
+
+    Task();
+    Task(const Task& other) = delete;
+    Task& operator=(const Task& other) = delete;
+    Task(Task&& other);
+    Task& operator=(Task&& other);
+    ~Task();
+    bool IsDone() const;
+    bool await_ready() const;
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> parent);
+    void await_resume() const;
+
+private:
+    friend class CoRobot;
+
+    explicit Task(std::coroutine_handle<promise_type> handle);
+
+    std::coroutine_handle<promise_type> Handle;
+};
+
+/**
+ * Robot written as a blocking loop in the style of classic CROBOTS. Run is started on the first tick
+ * and every action suspends it until a later one, e.g.
+ *
+ *     Task Run() override
+ *     {
+ *         while (true)
+ *         {
+ *             co_await Drive(5.0f);
+ *             co_await Wait(60);
+ *         }
+ *     }
+ *
+ * A loop that never awaits an action never gives the tick back
+ */
+class CoRobot : public IRobot
+{
+protected:
+    CoRobot();
+
+public:
+    class Action
+    {
+    public:
+        bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> handle) noexcept;
+        void await_resume() const noexcept;
+
+    private:
+        friend class CoRobot;
+
+        Action(CoRobot& robot, int ticks);
+
+        CoRobot& Robot;
+        int Ticks;
+    };
+
+    class ScanAction
+    {
+    public:
+        bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> handle) noexcept;
+        // scans once resumed, so the result sees the world after the tick
+        std::optional<float> await_resume();
+
+    private:
+        friend class CoRobot;
+
+        ScanAction(CoRobot& robot, float angle, float width);
+
+        CoRobot& Robot;
+        float Angle;
+        float Width;
+    };
+
+    virtual Task Run() = 0;
+    void Update(float deltaTime) final;
+
+    // suspends for the given number of ticks
+    Action Wait(int ticks);
+
+    // sets the speed and suspends for a tick
+    Action Drive(float speed);
+
+    // fires and suspends for a tick
+    Action Fire(float angle, float range);
+
+    // suspends for a tick and scans
+    ScanAction Scan(float angle, float width);
+
+    // seconds since the last tick, valid while running
+    float GetDeltaTime() const;
+
+private:
+    void Suspend(std::coroutine_handle<> handle, int ticks);
+
+    // declared first so it outlives every frame
+    FramePool Pool;
+    Task Main;
+    std::coroutine_handle<> Current;
+    int Remaining;
+    float DeltaTime;
+};
+
 }
\ No newline at end of file
@@ -1,9 +1,28 @@
 #include <crobots++/internal.hpp>
 #include <crobots++/robot.hpp>
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <coroutine>
+#include <cstddef>
+#include <new>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
 namespace crobots
 {
 
+static constexpr std::size_t kMinBlock = 64;
+// frames keep a pointer to their pool in front of them, padded so the frame stays aligned
+static constexpr std::size_t kFrameHeader = alignof(std::max_align_t);
+
+// the pool of the robot whose coroutines are running on this thread
+static thread_local FramePool* tPool = nullptr;
+
 IRobot::IRobot()
 {
 }
@@ -34,7 +53,23 @@ void IRobot::Fire(float angle, float range)
 
 std::optional<float> IRobot::Scan(float angle, float width)
 {
-    return {};
+    std::optional<float> nearest;
+    for (int i = 0; i < Context->Visible; i++)
+    {
+        float dx = Context->Sightings[i].X - Context->X;
+        float dy = Context->Sightings[i].Y - Context->Y;
+        float offset = std::remainder(std::atan2(dy, dx) - angle, 2.0f * std::numbers::pi_v<float>);
+        if (std::abs(offset) > width / 2.0f)
+        {
+            continue;
+        }
+        float distance = std::hypot(dx, dy);
+        if (!nearest || distance < *nearest)
+        {
+            nearest = distance;
+        }
+    }
+    return nearest;
 }
 
 float IRobot::GetHeat()
@@ -48,12 +83,331 @@ void IRobot::CoolDown()
 
 float IRobot::GetDamage()
 {
-    return 0.0f;
+    return Context->Damage;
 }
 
 float IRobot::GetTime()
+{
+    return Context->Time;
+}
+
+float IRobot::GetParameter(const std::string_view& name, float value, float min, float max)
+{
+    for (const Parameter& parameter : Context->Parameters)
+    {
+        if (parameter.Name == name)
+        {
+            return parameter.Value;
+        }
+    }
+    for (const Parameter& parameter : Context->Overrides)
+    {
+        if (parameter.Name == name)
+        {
+            value = parameter.Value;
+            break;
+        }
+    }
+    value = std::clamp(value, min, max);
+    Context->Parameters.emplace_back(std::string{name}, value, min, max);
+    return value;
+}
+
+int IRobot::GetIndex()
+{
+    return Context->Index;
+}
+
+int IRobot::GetTeam()
+{
+    return Context->Team;
+}
+
+bool IRobot::Send(int robot, const Message& message)
+{
+    if (Context->Outgoing == kOutboxSize)
+    {
+        return false;
+    }
+    Context->Outbox[Context->Outgoing] = message;
+    Context->Recipients[Context->Outgoing] = robot;
+    Context->Outgoing++;
+    return true;
+}
+
+bool IRobot::Broadcast(const Message& message)
+{
+    return Send(kBroadcast, message);
+}
+
+std::span<const Message> IRobot::Receive()
+{
+    return {Context->Inbox, std::size_t(Context->Incoming)};
+}
+
+FramePool::FramePool()
+    : Chunks{}
+    , Free{}
+    , Cursor{nullptr}
+    , Remaining{0}
+{
+}
+
+FramePool::~FramePool()
+{
+    for (void* chunk : Chunks)
+    {
+        ::operator delete(chunk);
+    }
+}
+
+void* FramePool::Allocate(std::size_t size)
+{
+    std::size_t block = std::bit_ceil(std::max(size, kMinBlock));
+    int index = std::countr_zero(block) - std::countr_zero(kMinBlock);
+    if (index >= kClasses)
+    {
+        return nullptr;
+    }
+    if (Free[index])
+    {
+        Block* head = Free[index];
+        Free[index] = head->Next;
+        return head;
+    }
+    if (Remaining < block)
+    {
+        // whatever is left of the old chunk is only lost until the pool goes away
+        Cursor = static_cast<std::byte*>(::operator new(kChunkSize));
+        Remaining = kChunkSize;
+        Chunks.push_back(Cursor);
+    }
+    void* pointer = Cursor;
+    Cursor += block;
+    Remaining -= block;
+    return pointer;
+}
+
+void FramePool::Deallocate(void* pointer, std::size_t size)
+{
+    std::size_t block = std::bit_ceil(std::max(size, kMinBlock));
+    int index = std::countr_zero(block) - std::countr_zero(kMinBlock);
+    Block* head = static_cast<Block*>(pointer);
+    head->Next = Free[index];
+    Free[index] = head;
+}
+
+Task::promise_type::promise_type()
+    : Parent{}
+{
+}
+
+Task Task::promise_type::get_return_object()
+{
+    return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+}
+
+std::suspend_always Task::promise_type::initial_suspend() noexcept
 {
     return {};
 }
 
+void Task::promise_type::return_void()
+{
+}
+
+void Task::promise_type::unhandled_exception()
+{
+    // surfaces from Update like it would from a plain robot
+    throw;
+}
+
+void* Task::promise_type::operator new(std::size_t size)
+{
+    FramePool* pool = tPool;
+    void* block = pool ? pool->Allocate(size + kFrameHeader) : nullptr;
+    if (!block)
+    {
+        pool = nullptr;
+        block = ::operator new(size + kFrameHeader);
+    }
+    *static_cast<FramePool**>(block) = pool;
+    return static_cast<std::byte*>(block) + kFrameHeader;
+}
+
+void Task::promise_type::operator delete(void* pointer, std::size_t size)
+{
+    void* block = static_cast<std::byte*>(pointer) - kFrameHeader;
+    FramePool* pool = *static_cast<FramePool**>(block);
+    if (pool)
+    {
+        pool->Deallocate(block, size + kFrameHeader);
+    }
+    else
+    {
+        ::operator delete(block);
+    }
+}
+
+Task::Task()
+    : Handle{}
+{
+}
+
+Task::Task(std::coroutine_handle<promise_type> handle)
+    : Handle{handle}
+{
+}
+
+Task::Task(Task&& other)
+    : Handle{std::exchange(other.Handle, {})}
+{
+}
+
+Task& Task::operator=(Task&& other)
+{
+    if (this != &other)
+    {
+        if (Handle)
+        {
+            Handle.destroy();
+        }
+        Handle = std::exchange(other.Handle, {});
+    }
+    return *this;
+}
+
+Task::~Task()
+{
+    if (Handle)
+    {
+        Handle.destroy();
+    }
+}
+
+bool Task::IsDone() const
+{
+    return !Handle || Handle.done();
+}
+
+bool Task::await_ready() const
+{
+    return IsDone();
+}
+
+std::coroutine_handle<> Task::await_suspend(std::coroutine_handle<> parent)
+{
+    Handle.promise().Parent = parent;
+    return Handle;
+}
+
+void Task::await_resume() const
+{
+}
+
+CoRobot::Action::Action(CoRobot& robot, int ticks)
+    : Robot{robot}
+    , Ticks{ticks}
+{
+}
+
+bool CoRobot::Action::await_ready() const noexcept
+{
+    return Ticks <= 0;
+}
+
+void CoRobot::Action::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    Robot.Suspend(handle, Ticks);
+}
+
+void CoRobot::Action::await_resume() const noexcept
+{
+}
+
+CoRobot::ScanAction::ScanAction(CoRobot& robot, float angle, float width)
+    : Robot{robot}
+    , Angle{angle}
+    , Width{width}
+{
+}
+
+bool CoRobot::ScanAction::await_ready() const noexcept
+{
+    return false;
+}
+
+void CoRobot::ScanAction::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    Robot.Suspend(handle, 1);
+}
+
+std::optional<float> CoRobot::ScanAction::await_resume()
+{
+    return Robot.IRobot::Scan(Angle, Width);
+}
+
+CoRobot::CoRobot()
+    : Pool{}
+    , Main{}
+    , Current{}
+    , Remaining{0}
+    , DeltaTime{0.0f}
+{
+}
+
+void CoRobot::Update(float deltaTime)
+{
+    if (Remaining > 0 && --Remaining > 0)
+    {
+        return;
+    }
+    DeltaTime = deltaTime;
+    FramePool* previous = std::exchange(tPool, &Pool);
+    if (!Main.Handle)
+    {
+        Main = Run();
+        Current = Main.Handle;
+    }
+    // cleared first so a body that returns, or suspends on anything but an action, is left alone
+    if (Current)
+    {
+        std::exchange(Current, {}).resume();
+    }
+    tPool = previous;
+}
+
+CoRobot::Action CoRobot::Wait(int ticks)
+{
+    return Action{*this, ticks};
+}
+
+CoRobot::Action CoRobot::Drive(float speed)
+{
+    SetSpeed(speed);
+    return Action{*this, 1};
+}
+
+CoRobot::Action CoRobot::Fire(float angle, float range)
+{
+    IRobot::Fire(angle, range);
+    return Action{*this, 1};
+}
+
+CoRobot::ScanAction CoRobot::Scan(float angle, float width)
+{
+    return ScanAction{*this, angle, width};
+}
+
+float CoRobot::GetDeltaTime() const
+{
+    return DeltaTime;
+}
+
+void CoRobot::Suspend(std::coroutine_handle<> handle, int ticks)
+{
+    Current = handle;
+    Remaining = ticks;
+}
+
 }
\ No newline at end of file
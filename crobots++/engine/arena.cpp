@@ -0,0 +1,226 @@
+#include <SDL3/SDL.h>
+#include <box2d/box2d.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "arena.hpp"
+
+// in front of every block so a free needs nothing but the pointer, padded to box2d's alignment
+static constexpr std::size_t kHeader = 32;
+
+struct Header
+{
+    // nullptr for blocks from the heap
+    Arena* Owner;
+    uint64_t Size;
+    int Index;
+};
+
+static_assert(sizeof(Header) <= kHeader);
+
+// the arena of the engine running on this thread
+static thread_local Arena* tArena = nullptr;
+static bool gInstalled = false;
+
+static void* AllocateBox2D(unsigned int size, int alignment)
+{
+    SDL_assert(std::size_t(alignment) <= kHeader);
+    if (tArena)
+    {
+        return tArena->Allocate(size);
+    }
+    Header* header = static_cast<Header*>(SDL_aligned_alloc(kHeader, size + kHeader));
+    if (!header)
+    {
+        return nullptr;
+    }
+    header->Owner = nullptr;
+    header->Size = size + kHeader;
+    header->Index = -1;
+    return reinterpret_cast<std::byte*>(header) + kHeader;
+}
+
+static void FreeBox2D(void* pointer)
+{
+    if (!pointer)
+    {
+        return;
+    }
+    // blocks go back to where they came from, whichever arena is bound now
+    Header* header = reinterpret_cast<Header*>(static_cast<std::byte*>(pointer) - kHeader);
+    if (header->Owner)
+    {
+        header->Owner->Deallocate(pointer);
+    }
+    else
+    {
+        SDL_aligned_free(header);
+    }
+}
+
+ArenaStats::ArenaStats()
+    : Allocations{0}
+    , Bytes{0}
+    , Peak{0}
+    , Reserved{0}
+{
+}
+
+Arena::Arena()
+    : Chunks{}
+    , Large{}
+    , Free{}
+    , Chunk{0}
+    , Offset{0}
+    , Live{0}
+    , Stats{}
+{
+}
+
+Arena::~Arena()
+{
+    for (void* block : Large)
+    {
+        SDL_aligned_free(block);
+    }
+    for (std::byte* chunk : Chunks)
+    {
+        SDL_aligned_free(chunk);
+    }
+}
+
+void* Arena::AllocateBlock(std::size_t size, int& index)
+{
+    std::size_t block = std::bit_ceil(std::max(size, kMinBlock));
+    index = std::countr_zero(block) - std::countr_zero(kMinBlock);
+    if (index >= kClasses)
+    {
+        index = kClasses;
+        void* pointer = SDL_aligned_alloc(kHeader, size);
+        if (pointer)
+        {
+            Large.push_back(pointer);
+        }
+        return pointer;
+    }
+    if (Free[index])
+    {
+        Block* head = Free[index];
+        Free[index] = head->Next;
+        return head;
+    }
+    // every block is a multiple of the smallest one, so headers carved back to back stay aligned
+    if (Chunk < Chunks.size() && kChunkSize - Offset < block)
+    {
+        // whatever is left of the old chunk is only lost until the next reset
+        Chunk++;
+        Offset = 0;
+    }
+    if (Chunk == Chunks.size())
+    {
+        std::byte* chunk = static_cast<std::byte*>(SDL_aligned_alloc(kHeader, kChunkSize));
+        if (!chunk)
+        {
+            return nullptr;
+        }
+        Chunks.push_back(chunk);
+        Stats.Reserved += kChunkSize;
+    }
+    void* pointer = Chunks[Chunk] + Offset;
+    Offset += block;
+    return pointer;
+}
+
+void* Arena::Allocate(std::size_t size)
+{
+    int index;
+    Header* header = static_cast<Header*>(AllocateBlock(size + kHeader, index));
+    if (!header)
+    {
+        SDL_Log("Failed to allocate %zu bytes", size);
+        return nullptr;
+    }
+    header->Owner = this;
+    header->Size = index == kClasses ? size + kHeader : kMinBlock << index;
+    header->Index = index;
+    Stats.Allocations++;
+    Stats.Bytes += size;
+    Live += header->Size;
+    Stats.Peak = std::max(Stats.Peak, Live);
+    return reinterpret_cast<std::byte*>(header) + kHeader;
+}
+
+void Arena::Deallocate(void* pointer)
+{
+    if (!pointer)
+    {
+        return;
+    }
+    Header* header = reinterpret_cast<Header*>(static_cast<std::byte*>(pointer) - kHeader);
+    SDL_assert(header->Owner == this);
+    Live -= header->Size;
+    if (header->Index == kClasses)
+    {
+        auto it = std::find(Large.begin(), Large.end(), static_cast<void*>(header));
+        SDL_assert(it != Large.end());
+        *it = Large.back();
+        Large.pop_back();
+        SDL_aligned_free(header);
+        return;
+    }
+    Block* head = reinterpret_cast<Block*>(header);
+    head->Next = Free[header->Index];
+    Free[header->Index] = head;
+}
+
+void Arena::Reset()
+{
+    for (void* block : Large)
+    {
+        SDL_aligned_free(block);
+    }
+    Large.clear();
+    std::fill(std::begin(Free), std::end(Free), nullptr);
+    Chunk = 0;
+    Offset = 0;
+    Live = 0;
+    uint64_t reserved = Stats.Reserved;
+    Stats = ArenaStats{};
+    Stats.Reserved = reserved;
+}
+
+const ArenaStats& Arena::GetStats() const
+{
+    return Stats;
+}
+
+void Arena::Install()
+{
+    if (gInstalled)
+    {
+        return;
+    }
+    b2SetAllocator(AllocateBox2D, FreeBox2D);
+    gInstalled = true;
+}
+
+bool Arena::IsInstalled()
+{
+    return gInstalled;
+}
+
+ArenaScope::ArenaScope(Arena* arena)
+    : Previous{tArena}
+{
+    tArena = arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+    tArena = Previous;
+}
\ No newline at end of file
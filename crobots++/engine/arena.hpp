@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// allocation counts since the arena was last reset, i.e. for the current match
+struct ArenaStats
+{
+    ArenaStats();
+
+    uint64_t Allocations;
+    uint64_t Bytes;
+    // most bytes live at once, counting block headers and rounding
+    uint64_t Peak;
+    // bytes taken from the heap, kept across resets
+    uint64_t Reserved;
+};
+
+// memory for everything one match allocates, box2d included. blocks come from size classes carved out of
+// chunks that are kept across matches, so after the first few matches a worker stops touching the heap and
+// a whole match is released with one Reset instead of a free per allocation. only ever used by one thread
+class Arena
+{
+public:
+    Arena();
+    Arena(const Arena& other) = delete;
+    Arena& operator=(const Arena& other) = delete;
+    ~Arena();
+
+    void* Allocate(std::size_t size);
+    // pointer must have come from Allocate on this arena, or from box2d while it was bound
+    void Deallocate(void* pointer);
+    // releases every block at once. nothing allocated before may be used after
+    void Reset();
+    const ArenaStats& GetStats() const;
+
+    // routes box2d's allocations to whichever arena is bound on the calling thread, or the heap if none is.
+    // must be called before the first world is created since blocks carry a header the default allocator lacks
+    static void Install();
+    static bool IsInstalled();
+
+private:
+    friend class ArenaScope;
+
+    // 64KB chunks. a match rarely needs more, so an idle engine doesn't sit on a megabyte
+    static constexpr int kClasses = 11;
+    static constexpr std::size_t kMinBlock = 64;
+    static constexpr std::size_t kChunkSize = kMinBlock << (kClasses - 1);
+
+    struct Block
+    {
+        Block* Next;
+    };
+
+    void* AllocateBlock(std::size_t size, int& index);
+
+    std::vector<std::byte*> Chunks;
+    // blocks too big for any class, straight from the heap and freed on reset
+    std::vector<void*> Large;
+    Block* Free[kClasses];
+    // chunk being carved and how far into it
+    std::size_t Chunk;
+    std::size_t Offset;
+    uint64_t Live;
+    ArenaStats Stats;
+};
+
+// binds an arena to the calling thread for the lifetime of the scope. nullptr binds the heap
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena* arena);
+    ArenaScope(const ArenaScope& other) = delete;
+    ArenaScope& operator=(const ArenaScope& other) = delete;
+    ~ArenaScope();
+
+private:
+    Arena* Previous;
+};
+
+// for engine side objects that should live and die with the match
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena* arena)
+        : Owner{arena}
+    {
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : Owner{other.Owner}
+    {
+    }
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(Owner->Allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count)
+    {
+        Owner->Deallocate(pointer);
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return Owner == other.Owner;
+    }
+
+private:
+    template<typename U>
+    friend class ArenaAllocator;
+
+    Arena* Owner;
+};
\ No newline at end of file
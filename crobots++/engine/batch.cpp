@@ -0,0 +1,554 @@
+#include <SDL3/SDL.h>
+#include <box2d/box2d.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+#include "batch.hpp"
+#include "map.hpp"
+#include "physics.hpp"
+#include "simd.hpp"
+#include "state.hpp"
+
+static constexpr float kEpsilon = std::numeric_limits<float>::epsilon();
+// box2d's defaults, so hits, masses and sleep line up with the reference
+static constexpr float kHitSpeed = 1.0f;
+static constexpr float kDensity = 1.0f;
+static constexpr float kSleepSpeed = 0.05f;
+static constexpr float kTimeToSleep = 0.5f;
+
+BatchWorld::BatchWorld(int matches)
+    : X{}
+    , Y{}
+    , VelocityX{}
+    , VelocityY{}
+    , Cos{}
+    , Sin{}
+    , ForceX{}
+    , ForceY{}
+    , AngularVelocity{}
+    , Radius{}
+    , Box{}
+    , InverseMass{}
+    , Sleep{}
+    , Active{}
+    , Hits{}
+    , Speeds{}
+    , Pending{}
+    , Used(matches, 0)
+    , Free(matches)
+    , Contacts(matches)
+    , Walls{}
+    , Matches{matches}
+    , Stride{(matches + kLanes - 1) / kLanes * kLanes}
+    , Rows{0}
+    , Width{0.0f}
+    , Timestep{0.0f}
+    , SubSteps{0}
+{
+    Pending.assign(Stride, 0.0f);
+}
+
+int BatchWorld::GetMatches() const
+{
+    return Matches;
+}
+
+void BatchWorld::Step()
+{
+    bool stepping = false;
+    for (int i = 0; i < Matches; i++)
+    {
+        if (Pending[i])
+        {
+            Contacts[i].clear();
+            stepping = true;
+        }
+    }
+    if (!stepping)
+    {
+        return;
+    }
+    for (int i = 0; i < SubSteps; i++)
+    {
+        Integrate(Timestep / SubSteps);
+        Bounce();
+        Collide();
+    }
+    std::fill(Pending.begin(), Pending.end(), 0.0f);
+}
+
+int BatchWorld::GetLane(int match, int body) const
+{
+    return body * Stride + match;
+}
+
+bool BatchWorld::CreateWorld(int match, const Map& layout, float width)
+{
+    DestroyWorld(match);
+    for (int y = 0; y < layout.GetSize(); y++)
+    {
+        for (int x = 0; x < layout.GetSize(); x++)
+        {
+            if (layout.IsSolid(x, y))
+            {
+                SDL_Log("Batch physics only models the empty arena");
+                return false;
+            }
+        }
+    }
+    if (!Walls.empty())
+    {
+        if (width != Width)
+        {
+            SDL_Log("Every match in a batch world must have the same arena: %f", width);
+            return false;
+        }
+        return true;
+    }
+    Width = width;
+    // only the outer wall, which the kernels treat as the arena's bounds rather than as segments
+    std::vector<std::vector<b2Vec2>> outlines;
+    layout.GetOutlines(outlines, width);
+    for (const std::vector<b2Vec2>& outline : outlines)
+    {
+        for (int i = 0; i < outline.size(); i++)
+        {
+            Walls.push_back({outline[i], outline[(i + 1) % outline.size()]});
+        }
+    }
+    return true;
+}
+
+void BatchWorld::DestroyWorld(int match)
+{
+    for (int i = 0; i < Used[match]; i++)
+    {
+        DestroyBody(match, i);
+    }
+    Used[match] = 0;
+    Free[match].clear();
+    Contacts[match].clear();
+    Pending[match] = 0.0f;
+}
+
+int BatchWorld::CreateBody(int match, BodyType type, const b2Transform& transform, const b2Vec2& velocity)
+{
+    int body;
+    if (!Free[match].empty())
+    {
+        body = Free[match].back();
+        Free[match].pop_back();
+    }
+    else
+    {
+        body = Used[match]++;
+        if (Used[match] > Rows)
+        {
+            Reserve(Used[match]);
+        }
+    }
+    int lane = GetLane(match, body);
+    X[lane] = transform.p.x;
+    Y[lane] = transform.p.y;
+    Cos[lane] = transform.q.c;
+    Sin[lane] = transform.q.s;
+    VelocityX[lane] = velocity.x;
+    VelocityY[lane] = velocity.y;
+    ForceX[lane] = 0.0f;
+    ForceY[lane] = 0.0f;
+    AngularVelocity[lane] = 0.0f;
+    Sleep[lane] = 0.0f;
+    Speeds[lane] = 0.0f;
+    Active[lane] = 1.0f;
+    if (type == BodyType::Robot)
+    {
+        Radius[lane] = kRobotSize / 2.0f;
+        Box[lane] = 1.0f;
+        InverseMass[lane] = 1.0f / (kDensity * kRobotSize * kRobotSize);
+        Hits[lane] = 1.0f;
+    }
+    else
+    {
+        Radius[lane] = kProjectileRadius;
+        Box[lane] = 0.0f;
+        InverseMass[lane] = 1.0f / (kDensity * std::numbers::pi_v<float> * kProjectileRadius * kProjectileRadius);
+        Hits[lane] = 0.0f;
+    }
+    return body;
+}
+
+void BatchWorld::DestroyBody(int match, int body)
+{
+    int lane = GetLane(match, body);
+    Active[lane] = 0.0f;
+    VelocityX[lane] = 0.0f;
+    VelocityY[lane] = 0.0f;
+    ForceX[lane] = 0.0f;
+    ForceY[lane] = 0.0f;
+    Speeds[lane] = 0.0f;
+    Free[match].push_back(body);
+}
+
+void BatchWorld::Request(int match, float timestep, int subSteps)
+{
+    SDL_assert(!SubSteps || (timestep == Timestep && subSteps == SubSteps));
+    Timestep = timestep;
+    SubSteps = subSteps;
+    Pending[match] = 1.0f;
+}
+
+void BatchWorld::Reserve(int rows)
+{
+    Rows = rows;
+    // new rows start out free in every match
+    for (std::vector<float>* lane : {&X, &Y, &VelocityX, &VelocityY, &Cos, &Sin, &ForceX, &ForceY, &AngularVelocity,
+        &Radius, &Box, &InverseMass, &Sleep, &Active, &Hits, &Speeds})
+    {
+        lane->resize(Rows * Stride, 0.0f);
+    }
+}
+
+void BatchWorld::Integrate(float timestep)
+{
+    Float4 step = Set(timestep);
+    Float4 zero = Set(0.0f);
+    Float4 one = Set(1.0f);
+    for (int i = 0; i < Rows * Stride; i += kLanes)
+    {
+        // lanes of matches sitting this step out are left exactly as they were
+        Mask4 live = Less(zero, Mul(Load(&Active[i]), Load(&Pending[i % Stride])));
+        Float4 sleep = Load(&Sleep[i]);
+        // sleeping bodies keep their velocity but stay put until a force, a contact or the engine wakes them
+        Mask4 awake = And(live, Less(sleep, Set(kTimeToSleep)));
+        Float4 moving = Select(awake, step, zero);
+        Float4 inverseMass = Load(&InverseMass[i]);
+        Float4 oldX = Load(&X[i]);
+        Float4 oldY = Load(&Y[i]);
+        Float4 oldVelocityX = Load(&VelocityX[i]);
+        Float4 oldVelocityY = Load(&VelocityY[i]);
+        Float4 velocityX = Add(oldVelocityX, Mul(Mul(Load(&ForceX[i]), inverseMass), moving));
+        Float4 velocityY = Add(oldVelocityY, Mul(Mul(Load(&ForceY[i]), inverseMass), moving));
+        Float4 x = Add(oldX, Mul(velocityX, moving));
+        Float4 y = Add(oldY, Mul(velocityY, moving));
+        // walls are perfectly elastic like box2d's chains. a box reaches further towards a wall the more it's turned
+        Float4 box = Mul(Load(&Box[i]), Sub(Add(Abs(Load(&Cos[i])), Abs(Load(&Sin[i]))), one));
+        Float4 extent = Mul(Load(&Radius[i]), Add(one, box));
+        Float4 high = Sub(Set(Width), extent);
+        Mask4 left = Less(x, extent);
+        Mask4 right = Less(high, x);
+        Mask4 bottom = Less(y, extent);
+        Mask4 top = Less(high, y);
+        Float4 speedX = Select(left, Sub(zero, velocityX), Select(right, velocityX, zero));
+        Float4 speedY = Select(bottom, Sub(zero, velocityY), Select(top, velocityY, zero));
+        Store(&Speeds[i], Select(awake, Max(Max(speedX, speedY), zero), zero));
+        velocityX = Select(left, Abs(velocityX), Select(right, Sub(zero, Abs(velocityX)), velocityX));
+        velocityY = Select(bottom, Abs(velocityY), Select(top, Sub(zero, Abs(velocityY)), velocityY));
+        x = Min(Max(x, extent), high);
+        y = Min(Max(y, extent), high);
+        // box2d's sleep timer. an awake body that stays slow long enough stops dead, a sleeping one is left be
+        Float4 speed2 = Add(Mul(velocityX, velocityX), Mul(velocityY, velocityY));
+        Float4 slept = Select(Less(speed2, Set(kSleepSpeed * kSleepSpeed)), Add(sleep, step), zero);
+        Mask4 still = Less(slept, Set(kTimeToSleep));
+        velocityX = Select(awake, Select(still, velocityX, zero), velocityX);
+        velocityY = Select(awake, Select(still, velocityY, zero), velocityY);
+        Store(&X[i], Select(live, x, oldX));
+        Store(&Y[i], Select(live, y, oldY));
+        Store(&VelocityX[i], Select(live, velocityX, oldVelocityX));
+        Store(&VelocityY[i], Select(live, velocityY, oldVelocityY));
+        Store(&Sleep[i], Select(awake, slept, sleep));
+        Store(&ForceX[i], Select(live, zero, Load(&ForceX[i])));
+        Store(&ForceY[i], Select(live, zero, Load(&ForceY[i])));
+    }
+}
+
+void BatchWorld::Bounce()
+{
+    Float4 hitSpeed = Set(kHitSpeed);
+    for (int i = 0; i < Rows * Stride; i += kLanes)
+    {
+        int bits = GetBits(Less(hitSpeed, Load(&Speeds[i])));
+        for (int j = 0; bits; j++, bits >>= 1)
+        {
+            if (!(bits & 1))
+            {
+                continue;
+            }
+            int lane = i + j;
+            // on whichever wall is nearest, which is the one it was pushed back from
+            float extent = GetExtent(lane);
+            float distances[4] = {X[lane] - extent, Width - extent - X[lane], Y[lane] - extent, Width - extent - Y[lane]};
+            int wall = std::min_element(distances, distances + 4) - distances;
+            Contact& contact = Contacts[lane % Stride].emplace_back();
+            contact.BodyA = lane / Stride;
+            contact.BodyB = kNoBody;
+            contact.Point.x = wall == 0 ? 0.0f : wall == 1 ? Width : X[lane];
+            contact.Point.y = wall == 2 ? 0.0f : wall == 3 ? Width : Y[lane];
+            contact.ApproachSpeed = Speeds[lane];
+            contact.Hit = true;
+        }
+    }
+}
+
+void BatchWorld::Collide()
+{
+    // every body against the ones after it in the same match, four matches at a time. bodies meet as circles
+    // and lose their approach speed, split by mass
+    Float4 zero = Set(0.0f);
+    for (int a = 0; a < Rows; a++)
+    {
+        for (int b = a + 1; b < Rows; b++)
+        {
+            for (int m = 0; m < Stride; m += kLanes)
+            {
+                int i = a * Stride + m;
+                int j = b * Stride + m;
+                Mask4 live = Less(zero, Mul(Mul(Load(&Active[i]), Load(&Active[j])), Load(&Pending[m])));
+                Float4 radiusA = Load(&Radius[i]);
+                Float4 radius = Add(radiusA, Load(&Radius[j]));
+                Float4 xA = Load(&X[i]);
+                Float4 yA = Load(&Y[i]);
+                Float4 xB = Load(&X[j]);
+                Float4 yB = Load(&Y[j]);
+                Float4 dx = Sub(xB, xA);
+                Float4 dy = Sub(yB, yA);
+                Float4 distance2 = Add(Mul(dx, dx), Mul(dy, dy));
+                Mask4 touching = And(Less(distance2, Mul(radius, radius)), live);
+                if (!GetBits(touching))
+                {
+                    continue;
+                }
+                Float4 distance = Sqrt(Max(distance2, Set(kEpsilon)));
+                Float4 normalX = Div(dx, distance);
+                Float4 normalY = Div(dy, distance);
+                Float4 inverseA = Load(&InverseMass[i]);
+                Float4 inverseB = Load(&InverseMass[j]);
+                Float4 inverse = Max(Add(inverseA, inverseB), Set(kEpsilon));
+                Float4 push = Select(touching, Div(Sub(radius, distance), inverse), zero);
+                xA = Sub(xA, Mul(normalX, Mul(push, inverseA)));
+                yA = Sub(yA, Mul(normalY, Mul(push, inverseA)));
+                Store(&X[i], xA);
+                Store(&Y[i], yA);
+                Store(&X[j], Add(xB, Mul(normalX, Mul(push, inverseB))));
+                Store(&Y[j], Add(yB, Mul(normalY, Mul(push, inverseB))));
+                Float4 velocityAX = Load(&VelocityX[i]);
+                Float4 velocityAY = Load(&VelocityY[i]);
+                Float4 velocityBX = Load(&VelocityX[j]);
+                Float4 velocityBY = Load(&VelocityY[j]);
+                Float4 approach = Add(Mul(Sub(velocityBX, velocityAX), normalX), Mul(Sub(velocityBY, velocityAY), normalY));
+                Mask4 closing = And(touching, Less(approach, zero));
+                Float4 impulse = Select(closing, Div(approach, inverse), zero);
+                Store(&VelocityX[i], Add(velocityAX, Mul(normalX, Mul(impulse, inverseA))));
+                Store(&VelocityY[i], Add(velocityAY, Mul(normalY, Mul(impulse, inverseA))));
+                Store(&VelocityX[j], Sub(velocityBX, Mul(normalX, Mul(impulse, inverseB))));
+                Store(&VelocityY[j], Sub(velocityBY, Mul(normalY, Mul(impulse, inverseB))));
+                // a collision wakes both sides, like box2d joining them into one island
+                Store(&Sleep[i], Select(closing, zero, Load(&Sleep[i])));
+                Store(&Sleep[j], Select(closing, zero, Load(&Sleep[j])));
+                // hits are reported if either body wants them, the same as box2d's per shape flag
+                Float4 hits = Add(Load(&Hits[i]), Load(&Hits[j]));
+                int bits = GetBits(And(And(closing, Less(Set(kHitSpeed), Sub(zero, approach))), Less(zero, hits)));
+                if (!bits)
+                {
+                    continue;
+                }
+                float speeds[kLanes];
+                float pointsX[kLanes];
+                float pointsY[kLanes];
+                Store(speeds, approach);
+                Store(pointsX, Add(xA, Mul(normalX, radiusA)));
+                Store(pointsY, Add(yA, Mul(normalY, radiusA)));
+                for (int k = 0; k < kLanes; k++)
+                {
+                    if ((bits >> k) & 1)
+                    {
+                        Contact& contact = Contacts[m + k].emplace_back();
+                        contact.BodyA = a;
+                        contact.BodyB = b;
+                        contact.Point = {pointsX[k], pointsY[k]};
+                        contact.ApproachSpeed = -speeds[k];
+                        contact.Hit = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+float BatchWorld::GetExtent(int lane) const
+{
+    return Radius[lane] * (1.0f + Box[lane] * (std::abs(Cos[lane]) + std::abs(Sin[lane]) - 1.0f));
+}
+
+BatchPhysics::BatchPhysics()
+    : Owned{std::make_unique<BatchWorld>(1)}
+    , World{Owned.get()}
+    , Match{0}
+{
+}
+
+BatchPhysics::BatchPhysics(BatchWorld* world, int match)
+    : Owned{}
+    , World{world}
+    , Match{match}
+{
+}
+
+bool BatchPhysics::CreateWorld(const Map& layout, float width)
+{
+    return World->CreateWorld(Match, layout, width);
+}
+
+void BatchPhysics::DestroyWorld()
+{
+    World->DestroyWorld(Match);
+}
+
+int BatchPhysics::CreateBody(BodyType type, const b2Transform& transform, const b2Vec2& velocity)
+{
+    return World->CreateBody(Match, type, transform, velocity);
+}
+
+void BatchPhysics::DestroyBody(int body)
+{
+    World->DestroyBody(Match, body);
+}
+
+void BatchPhysics::Step(float timestep, int subSteps)
+{
+    World->Request(Match, timestep, subSteps);
+    if (Owned)
+    {
+        World->Step();
+    }
+}
+
+const std::vector<Contact>& BatchPhysics::GetContacts() const
+{
+    return World->Contacts[Match];
+}
+
+b2Transform BatchPhysics::GetTransform(int body) const
+{
+    int lane = World->GetLane(Match, body);
+    return {{World->X[lane], World->Y[lane]}, {World->Cos[lane], World->Sin[lane]}};
+}
+
+void BatchPhysics::SetTransform(int body, const b2Transform& transform)
+{
+    int lane = World->GetLane(Match, body);
+    World->X[lane] = transform.p.x;
+    World->Y[lane] = transform.p.y;
+    World->Cos[lane] = transform.q.c;
+    World->Sin[lane] = transform.q.s;
+}
+
+b2Vec2 BatchPhysics::GetLinearVelocity(int body) const
+{
+    int lane = World->GetLane(Match, body);
+    return {World->VelocityX[lane], World->VelocityY[lane]};
+}
+
+void BatchPhysics::SetLinearVelocity(int body, const b2Vec2& velocity)
+{
+    int lane = World->GetLane(Match, body);
+    World->VelocityX[lane] = velocity.x;
+    World->VelocityY[lane] = velocity.y;
+    // like box2d, only a velocity that goes somewhere wakes the body
+    if (velocity.x != 0.0f || velocity.y != 0.0f)
+    {
+        World->Sleep[lane] = 0.0f;
+    }
+}
+
+float BatchPhysics::GetAngularVelocity(int body) const
+{
+    return World->AngularVelocity[World->GetLane(Match, body)];
+}
+
+void BatchPhysics::SetAngularVelocity(int body, float velocity)
+{
+    World->AngularVelocity[World->GetLane(Match, body)] = velocity;
+}
+
+bool BatchPhysics::IsAwake(int body) const
+{
+    return World->Sleep[World->GetLane(Match, body)] < kTimeToSleep;
+}
+
+void BatchPhysics::SetAwake(int body, bool awake)
+{
+    World->Sleep[World->GetLane(Match, body)] = awake ? 0.0f : kTimeToSleep;
+}
+
+float BatchPhysics::GetMass(int body) const
+{
+    return 1.0f / World->InverseMass[World->GetLane(Match, body)];
+}
+
+void BatchPhysics::ApplyForce(int body, const b2Vec2& force)
+{
+    int lane = World->GetLane(Match, body);
+    World->ForceX[lane] += force.x;
+    World->ForceY[lane] += force.y;
+    World->Sleep[lane] = 0.0f;
+}
+
+void BatchPhysics::GetWalls(const b2AABB& bounds, std::vector<b2Segment>& walls) const
+{
+    for (const b2Segment& wall : World->Walls)
+    {
+        if (b2AABB_Overlaps(bounds, {b2Min(wall.point1, wall.point2), b2Max(wall.point1, wall.point2)}))
+        {
+            walls.push_back(wall);
+        }
+    }
+}
+
+void BatchPhysics::Draw(State& state, const b2AABB* bounds) const
+{
+    for (const b2Segment& wall : World->Walls)
+    {
+        DebugSegment& segment = state.Segments.emplace_back();
+        segment.P1 = wall.point1;
+        segment.P2 = wall.point2;
+        segment.Color = b2_colorPaleGreen;
+    }
+    // projectiles are circles, which the state has no room for. box2d's are left out too
+    constexpr float kHalf = kRobotSize / 2.0f;
+    for (int i = 0; i < World->Used[Match]; i++)
+    {
+        int lane = World->GetLane(Match, i);
+        if (!World->Active[lane] || !World->Box[lane])
+        {
+            continue;
+        }
+        float reach = World->GetExtent(lane);
+        b2Vec2 extent{reach, reach};
+        b2Vec2 position{World->X[lane], World->Y[lane]};
+        if (bounds && !b2AABB_Overlaps(*bounds, {b2Sub(position, extent), b2Add(position, extent)}))
+        {
+            continue;
+        }
+        DebugPolygon& polygon = state.Polygons.emplace_back();
+        polygon.Transform = GetTransform(i);
+        polygon.Vertices[0] = {-kHalf, -kHalf};
+        polygon.Vertices[1] = {kHalf, -kHalf};
+        polygon.Vertices[2] = {kHalf, kHalf};
+        polygon.Vertices[3] = {-kHalf, kHalf};
+        polygon.Count = 4;
+        polygon.Color = IsAwake(i) ? b2_colorPink : b2_colorGray;
+    }
+}
+
+void BatchPhysics::GetProfile(TickProfile& profile) const
+{
+    profile.Physics = {};
+    profile.Counters = {};
+    profile.Counters.bodyCount = World->Used[Match] - World->Free[Match].size();
+    profile.Counters.contactCount = World->Contacts[Match].size();
+}
\ No newline at end of file
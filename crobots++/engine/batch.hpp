@@ -0,0 +1,118 @@
+#pragma once
+
+#include <box2d/box2d.h>
+
+#include <memory>
+#include <vector>
+
+#include "map.hpp"
+#include "physics.hpp"
+#include "state.hpp"
+
+// a specialized model in place of box2d worlds, for many independent matches stepped in lockstep. robots are
+// oriented unit boxes against the arena walls and circles against each other, projectiles are small circles.
+// every body of every match lives in structure of arrays lanes ordered body-major, so the same body of
+// neighbouring matches sits side by side and the kernels step four matches at a time. results are close to
+// box2d's rather than identical, and only the empty arena is modelled. bodies only turn when they're set to,
+// since nothing here applies torque
+class BatchWorld
+{
+public:
+    explicit BatchWorld(int matches);
+    int GetMatches() const;
+    // steps every match that asked to since the last call, together. every match must ask with the same
+    // timestep and substeps
+    void Step();
+
+private:
+    friend class BatchPhysics;
+
+    int GetLane(int match, int body) const;
+    bool CreateWorld(int match, const Map& layout, float width);
+    void DestroyWorld(int match);
+    int CreateBody(int match, BodyType type, const b2Transform& transform, const b2Vec2& velocity);
+    void DestroyBody(int match, int body);
+    void Request(int match, float timestep, int subSteps);
+    // grows every lane to fit rows bodies per match
+    void Reserve(int rows);
+    // the integration and wall kernel
+    void Integrate(float timestep);
+    // wall hits from the last integration
+    void Bounce();
+    // the pairwise contact kernel
+    void Collide();
+    float GetExtent(int lane) const;
+
+    std::vector<float> X;
+    std::vector<float> Y;
+    std::vector<float> VelocityX;
+    std::vector<float> VelocityY;
+    std::vector<float> Cos;
+    std::vector<float> Sin;
+    std::vector<float> ForceX;
+    std::vector<float> ForceY;
+    std::vector<float> AngularVelocity;
+    std::vector<float> Radius;
+    // 1 for boxes, whose reach towards a wall depends on their heading, 0 for circles
+    std::vector<float> Box;
+    std::vector<float> InverseMass;
+    // seconds spent below the sleep speed
+    std::vector<float> Sleep;
+    // 1 for bodies in use, 0 for free and padding lanes so they never move or touch anything
+    std::vector<float> Active;
+    // 1 for bodies whose contacts are reported as hits
+    std::vector<float> Hits;
+    // how fast each body met a wall in the last substep, 0 if it didn't
+    std::vector<float> Speeds;
+    // one lane per match, 1 for the ones stepping
+    std::vector<float> Pending;
+    // per match
+    std::vector<int> Used;
+    std::vector<std::vector<int>> Free;
+    std::vector<std::vector<Contact>> Contacts;
+    // every match has the same arena
+    std::vector<b2Segment> Walls;
+    int Matches;
+    // lanes per body, the match count padded to a whole vector
+    int Stride;
+    // bodies per match the lanes have room for
+    int Rows;
+    float Width;
+    float Timestep;
+    int SubSteps;
+};
+
+// one match of a batch world
+class BatchPhysics : public IPhysics
+{
+public:
+    // a world of its own, stepped as soon as it's asked to
+    BatchPhysics();
+    // a match in world, which steps it with the rest. world must outlive it
+    BatchPhysics(BatchWorld* world, int match);
+    bool CreateWorld(const Map& layout, float width) override;
+    void DestroyWorld() override;
+    int CreateBody(BodyType type, const b2Transform& transform, const b2Vec2& velocity) override;
+    void DestroyBody(int body) override;
+    // only asks to be stepped on a shared world, the contacts and bodies change with the next BatchWorld::Step
+    void Step(float timestep, int subSteps) override;
+    const std::vector<Contact>& GetContacts() const override;
+    b2Transform GetTransform(int body) const override;
+    void SetTransform(int body, const b2Transform& transform) override;
+    b2Vec2 GetLinearVelocity(int body) const override;
+    void SetLinearVelocity(int body, const b2Vec2& velocity) override;
+    float GetAngularVelocity(int body) const override;
+    void SetAngularVelocity(int body, float velocity) override;
+    bool IsAwake(int body) const override;
+    void SetAwake(int body, bool awake) override;
+    float GetMass(int body) const override;
+    void ApplyForce(int body, const b2Vec2& force) override;
+    void GetWalls(const b2AABB& bounds, std::vector<b2Segment>& walls) const override;
+    void Draw(State& state, const b2AABB* bounds) const override;
+    void GetProfile(TickProfile& profile) const override;
+
+private:
+    std::unique_ptr<BatchWorld> Owned;
+    BatchWorld* World;
+    int Match;
+};
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include <box2d/box2d.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "box2d_physics.hpp"
+#include "map.hpp"
+#include "physics.hpp"
+#include "state.hpp"
+
+// walls are the only thing that blocks line of sight
+static constexpr uint64_t kWallCategory = 2;
+
+// box2d keeps worlds in a global table that isn't safe to modify from several threads
+static std::mutex gWorldMutex;
+
+static void DrawSolidPolygon(b2Transform transform, const b2Vec2* vertices, int count, float radius, b2HexColor color, void* context)
+{
+    State* state = static_cast<State*>(context);
+    DebugPolygon& polygon = state->Polygons.emplace_back();
+    polygon.Transform = transform;
+    polygon.Count = std::min(count, B2_MAX_POLYGON_VERTICES);
+    std::copy(vertices, vertices + polygon.Count, polygon.Vertices);
+    polygon.Color = color;
+}
+
+static void DrawSegment(b2Vec2 p1, b2Vec2 p2, b2HexColor color, void* context)
+{
+    State* state = static_cast<State*>(context);
+    DebugSegment& segment = state->Segments.emplace_back();
+    segment.P1 = p1;
+    segment.P2 = p2;
+    segment.Color = color;
+}
+
+Box2DPhysics::Box2DPhysics()
+    : WorldID{}
+    , ChainBodyID{}
+    , Bodies{}
+    , Free{}
+    , Contacts{}
+{
+}
+
+bool Box2DPhysics::CreateWorld(const Map& layout, float width)
+{
+    DestroyWorld();
+    {
+        b2WorldDef worldDef = b2DefaultWorldDef();
+        worldDef.gravity.x = 0.0f;
+        worldDef.gravity.y = 0.0f;
+        std::lock_guard lock{gWorldMutex};
+        WorldID = b2CreateWorld(&worldDef);
+    }
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.type = b2_staticBody;
+    bodyDef.position = {0.0f, 0.0f};
+    ChainBodyID = b2CreateBody(WorldID, &bodyDef);
+    // the outer wall is just the first outline, an empty map has nothing else
+    std::vector<std::vector<b2Vec2>> outlines;
+    layout.GetOutlines(outlines, width);
+    b2SurfaceMaterial material{};
+    material.friction = 0.0f;
+    material.restitution = 1.0f;
+    std::vector<b2SurfaceMaterial> materials;
+    for (const std::vector<b2Vec2>& outline : outlines)
+    {
+        materials.assign(outline.size(), material);
+        b2ChainDef chainDef = b2DefaultChainDef();
+        chainDef.points = outline.data();
+        chainDef.count = outline.size();
+        chainDef.materials = materials.data();
+        chainDef.materialCount = materials.size();
+        chainDef.filter.categoryBits = kWallCategory;
+        chainDef.isLoop = true;
+        b2CreateChain(ChainBodyID, &chainDef);
+    }
+    b2Body_EnableHitEvents(ChainBodyID, true);
+    b2Body_EnableContactEvents(ChainBodyID, true);
+    return true;
+}
+
+void Box2DPhysics::DestroyWorld()
+{
+    if (B2_IS_NON_NULL(WorldID))
+    {
+        std::lock_guard lock{gWorldMutex};
+        b2DestroyWorld(WorldID);
+    }
+    WorldID = b2_nullWorldId;
+    ChainBodyID = b2_nullBodyId;
+    Bodies.clear();
+    Free.clear();
+    Contacts.clear();
+}
+
+int Box2DPhysics::CreateBody(BodyType type, const b2Transform& transform, const b2Vec2& velocity)
+{
+    int body = Bodies.size();
+    if (!Free.empty())
+    {
+        body = Free.back();
+        Free.pop_back();
+    }
+    else
+    {
+        Bodies.emplace_back();
+    }
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.type = b2_dynamicBody;
+    bodyDef.position = transform.p;
+    bodyDef.rotation = transform.q;
+    bodyDef.linearVelocity = velocity;
+    bodyDef.isBullet = type == BodyType::Projectile;
+    // off by one so the walls' null user data reads as kNoBody
+    bodyDef.userData = reinterpret_cast<void*>(intptr_t(body + 1));
+    b2BodyId bodyID = b2CreateBody(WorldID, &bodyDef);
+    b2ShapeDef shapeDef = b2DefaultShapeDef();
+    if (type == BodyType::Robot)
+    {
+        b2Polygon polygon = b2MakeBox(kRobotSize / 2.0f, kRobotSize / 2.0f);
+        b2CreatePolygonShape(bodyID, &shapeDef, &polygon);
+        b2Body_EnableHitEvents(bodyID, true);
+        b2Body_EnableContactEvents(bodyID, true);
+    }
+    else
+    {
+        b2Circle circle{{0.0f, 0.0f}, kProjectileRadius};
+        b2CreateCircleShape(bodyID, &shapeDef, &circle);
+    }
+    Bodies[body] = bodyID;
+    return body;
+}
+
+void Box2DPhysics::DestroyBody(int body)
+{
+    b2DestroyBody(Bodies[body]);
+    Bodies[body] = b2_nullBodyId;
+    Free.push_back(body);
+}
+
+void Box2DPhysics::Step(float timestep, int subSteps)
+{
+    b2World_Step(WorldID, timestep, subSteps);
+    Contacts.clear();
+    b2ContactEvents contactEvents = b2World_GetContactEvents(WorldID);
+    for (int i = 0; i < contactEvents.hitCount; i++)
+    {
+        const b2ContactHitEvent& event = contactEvents.hitEvents[i];
+        Contact& contact = Contacts.emplace_back();
+        contact.BodyA = GetBody(event.shapeIdA);
+        contact.BodyB = GetBody(event.shapeIdB);
+        contact.Point = event.point;
+        contact.ApproachSpeed = event.approachSpeed;
+        contact.Hit = true;
+    }
+    for (int i = 0; i < contactEvents.endCount; i++)
+    {
+        const b2ContactEndTouchEvent& event = contactEvents.endEvents[i];
+        // either shape may have been destroyed during the step
+        if (!b2Shape_IsValid(event.shapeIdA) || !b2Shape_IsValid(event.shapeIdB))
+        {
+            continue;
+        }
+        Contact& contact = Contacts.emplace_back();
+        contact.BodyA = GetBody(event.shapeIdA);
+        contact.BodyB = GetBody(event.shapeIdB);
+        contact.Point = {0.0f, 0.0f};
+        contact.ApproachSpeed = 0.0f;
+        contact.Hit = false;
+    }
+}
+
+const std::vector<Contact>& Box2DPhysics::GetContacts() const
+{
+    return Contacts;
+}
+
+b2Transform Box2DPhysics::GetTransform(int body) const
+{
+    return b2Body_GetTransform(Bodies[body]);
+}
+
+void Box2DPhysics::SetTransform(int body, const b2Transform& transform)
+{
+    b2Body_SetTransform(Bodies[body], transform.p, transform.q);
+}
+
+b2Vec2 Box2DPhysics::GetLinearVelocity(int body) const
+{
+    return b2Body_GetLinearVelocity(Bodies[body]);
+}
+
+void Box2DPhysics::SetLinearVelocity(int body, const b2Vec2& velocity)
+{
+    b2Body_SetLinearVelocity(Bodies[body], velocity);
+}
+
+float Box2DPhysics::GetAngularVelocity(int body) const
+{
+    return b2Body_GetAngularVelocity(Bodies[body]);
+}
+
+void Box2DPhysics::SetAngularVelocity(int body, float velocity)
+{
+    b2Body_SetAngularVelocity(Bodies[body], velocity);
+}
+
+bool Box2DPhysics::IsAwake(int body) const
+{
+    return b2Body_IsAwake(Bodies[body]);
+}
+
+void Box2DPhysics::SetAwake(int body, bool awake)
+{
+    b2Body_SetAwake(Bodies[body], awake);
+}
+
+float Box2DPhysics::GetMass(int body) const
+{
+    return b2Body_GetMass(Bodies[body]);
+}
+
+void Box2DPhysics::ApplyForce(int body, const b2Vec2& force)
+{
+    b2Body_ApplyForceToCenter(Bodies[body], force, true);
+}
+
+void Box2DPhysics::GetWalls(const b2AABB& bounds, std::vector<b2Segment>& walls) const
+{
+    b2QueryFilter filter = b2DefaultQueryFilter();
+    filter.maskBits = kWallCategory;
+    b2World_OverlapAABB(WorldID, bounds, filter, [](b2ShapeId shapeID, void* context)
+    {
+        // the chain body sits at the origin, so its local segments are already in world space
+        static_cast<std::vector<b2Segment>*>(context)->push_back(b2Shape_GetChainSegment(shapeID).segment);
+        return true;
+    }, &walls);
+}
+
+void Box2DPhysics::Draw(State& state, const b2AABB* bounds) const
+{
+    b2DebugDraw debugDraw = b2DefaultDebugDraw();
+    debugDraw.context = &state;
+    debugDraw.DrawSolidPolygonFcn = DrawSolidPolygon;
+    debugDraw.DrawSegmentFcn = DrawSegment;
+    debugDraw.drawShapes = true;
+    if (bounds)
+    {
+        debugDraw.drawingBounds = *bounds;
+        debugDraw.useDrawingBounds = true;
+    }
+    b2World_Draw(WorldID, &debugDraw);
+}
+
+void Box2DPhysics::GetProfile(TickProfile& profile) const
+{
+    profile.Physics = b2World_GetProfile(WorldID);
+    profile.Counters = b2World_GetCounters(WorldID);
+}
+
+int Box2DPhysics::GetBody(b2ShapeId shapeID) const
+{
+    return int(reinterpret_cast<intptr_t>(b2Body_GetUserData(b2Shape_GetBody(shapeID)))) - 1;
+}
\ No newline at end of file
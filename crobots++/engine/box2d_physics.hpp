@@ -0,0 +1,45 @@
+#pragma once
+
+#include <box2d/box2d.h>
+
+#include <vector>
+
+#include "map.hpp"
+#include "physics.hpp"
+#include "state.hpp"
+
+class Box2DPhysics : public IPhysics
+{
+public:
+    Box2DPhysics();
+    bool CreateWorld(const Map& layout, float width) override;
+    void DestroyWorld() override;
+    int CreateBody(BodyType type, const b2Transform& transform, const b2Vec2& velocity) override;
+    void DestroyBody(int body) override;
+    void Step(float timestep, int subSteps) override;
+    const std::vector<Contact>& GetContacts() const override;
+    b2Transform GetTransform(int body) const override;
+    void SetTransform(int body, const b2Transform& transform) override;
+    b2Vec2 GetLinearVelocity(int body) const override;
+    void SetLinearVelocity(int body, const b2Vec2& velocity) override;
+    float GetAngularVelocity(int body) const override;
+    void SetAngularVelocity(int body, float velocity) override;
+    bool IsAwake(int body) const override;
+    void SetAwake(int body, bool awake) override;
+    float GetMass(int body) const override;
+    void ApplyForce(int body, const b2Vec2& force) override;
+    void GetWalls(const b2AABB& bounds, std::vector<b2Segment>& walls) const override;
+    void Draw(State& state, const b2AABB* bounds) const override;
+    void GetProfile(TickProfile& profile) const override;
+
+private:
+    // the body a shape belongs to, kNoBody for the walls
+    int GetBody(b2ShapeId shapeID) const;
+
+    b2WorldId WorldID;
+    b2BodyId ChainBodyID;
+    // indexed by body, null for free slots
+    std::vector<b2BodyId> Bodies;
+    std::vector<int> Free;
+    std::vector<Contact> Contacts;
+};
\ No newline at end of file
@@ -138,6 +138,11 @@ public:
         return BufferSize;
     }
 
+    uint32_t GetCapacity() const
+    {
+        return BufferCapacity;
+    }
+
 private:
     SDL_GPUBuffer* Buffer;
     SDL_GPUTransferBuffer* TransferBuffer;
@@ -6,6 +6,7 @@
 #include <cmath>
 
 #include "camera.hpp"
+#include "frustum.hpp"
 
 static constexpr glm::vec3 kUp{0.0f, 1.0f, 0.0f};
 static constexpr float kMaxPitch = glm::pi<float>() / 2.0f - 0.01f;
@@ -19,6 +20,7 @@ Camera::Camera()
     , Right{}
     , Up{}
     , ViewProj{}
+    , ViewFrustum{}
     , Size{1, 1}
     , Pitch{0.0f}
     , Yaw{0.0f}
@@ -28,6 +30,7 @@ Camera::Camera()
     , Fov{glm::radians(60.0f)}
     , Near{0.1f}
     , Far{500.0f}
+    , Dirty{true}
 {
     SetRotation(0.0f, 0.0f);
 }
@@ -55,6 +58,8 @@ void Camera::Update()
         break;
     }
     ViewProj = proj * view;
+    ViewFrustum.Update(ViewProj);
+    Dirty = false;
 }
 
 void Camera::SetType(CameraType type)
@@ -83,6 +88,7 @@ void Camera::SetRotation(float pitch, float yaw)
     Right = glm::normalize(Right);
     Up = glm::cross(Right, Forward);
     Up = glm::normalize(Up);
+    Dirty = true;
     switch (Type)
     {
     case CameraType::ArcBall:
@@ -93,12 +99,15 @@ void Camera::SetRotation(float pitch, float yaw)
 
 void Camera::SetSize(int width, int height)
 {
-    Size = {std::max(width, 1), std::max(height, 1)};
+    glm::ivec2 size{std::max(width, 1), std::max(height, 1)};
+    Dirty = Dirty || size != Size;
+    Size = size;
 }
 
 void Camera::SetCenter(float x, float y)
 {
     Center = {x, 0.0f, y};
+    Dirty = true;
 }
 
 void Camera::MouseScroll(float delta)
@@ -107,12 +116,14 @@ void Camera::MouseScroll(float delta)
     {
     case CameraType::ArcBall:
         Position += Forward * delta * ZoomSpeed;
+        Dirty = true;
         break;
     case CameraType::FreeCam:
         MoveSpeed += std::max(delta * kAcceleration, 0.0f);
         break;
     case CameraType::TopDown:
         Position += Forward * delta * MoveSpeed;
+        Dirty = true;
         break;
     }
 }
@@ -124,6 +135,7 @@ void Camera::MouseMotion(float dx, float dy)
     case CameraType::TopDown:
         Position += Right * dx * MoveSpeed;
         Position += Up * dy * MoveSpeed;
+        Dirty = true;
         break;
     case CameraType::ArcBall:
         {
@@ -148,6 +160,8 @@ void Camera::Move(float dx, float dy, float dz, float dt)
         Position += Forward * dz * MoveSpeed * dt;
         Position += Right * dx * MoveSpeed * dt;
         Position += kUp * dy * MoveSpeed * dt;
+        // called every frame, mostly standing still
+        Dirty = Dirty || dx || dy || dz;
         break;
     }
 }
@@ -167,6 +181,11 @@ const glm::mat4& Camera::GetViewProj() const
     return ViewProj;
 }
 
+const Frustum& Camera::GetFrustum() const
+{
+    return ViewFrustum;
+}
+
 int Camera::GetWidth() const
 {
     return Size.x;
@@ -175,4 +194,9 @@ int Camera::GetWidth() const
 int Camera::GetHeight() const
 {
     return Size.y;
+}
+
+bool Camera::IsDirty() const
+{
+    return Dirty;
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include "frustum.hpp"
+
 enum class CameraType
 {
     Default,
@@ -25,8 +27,11 @@ public:
     CameraType GetType() const;
     const glm::vec3& GetPosition() const;
     const glm::mat4& GetViewProj() const;
+    const Frustum& GetFrustum() const;
     int GetWidth() const;
     int GetHeight() const;
+    // true if the view changed since the last Update
+    bool IsDirty() const;
 
 private:
     CameraType Type;
@@ -36,6 +41,7 @@ private:
     glm::vec3 Right;
     glm::vec3 Up;
     glm::mat4 ViewProj;
+    Frustum ViewFrustum;
     glm::ivec2 Size;
     float Pitch;
     float Yaw;
@@ -45,4 +51,5 @@ private:
     float Fov;
     float Near;
     float Far;
+    bool Dirty;
 };
\ No newline at end of file
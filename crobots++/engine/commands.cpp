@@ -0,0 +1,380 @@
+#include <SDL3/SDL.h>
+#include <crobots++/internal.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "commands.hpp"
+#include "engine.hpp"
+#include "map.hpp"
+
+static constexpr char kMagic[8] = {'C', 'R', 'B', 'C', 'M', 'D', 0, 0};
+static constexpr uint32_t kVersion = 4;
+// per robot flags of what a record changes
+static constexpr uint8_t kSpeed = 1;
+static constexpr uint8_t kAcceleration = 2;
+// replaying past the end of a log leaves every command as it was
+static constexpr uint64_t kNever = UINT64_MAX;
+
+template<typename T>
+static void Write(std::ofstream& file, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool Read(std::ifstream& file, T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return !file.fail();
+}
+
+template<typename T>
+static void Append(std::vector<uint8_t>& data, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static bool Extract(const std::vector<uint8_t>& data, size_t& offset, T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (offset + sizeof(T) > data.size())
+    {
+        return false;
+    }
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+// seven bits per byte, so the common short runs of unchanged ticks take one
+static void AppendVarint(std::vector<uint8_t>& data, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        data.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    data.push_back(uint8_t(value));
+}
+
+static bool ExtractVarint(const std::vector<uint8_t>& data, size_t& offset, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (offset == data.size())
+        {
+            return false;
+        }
+        uint8_t byte = data[offset++];
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+CommandLog::CommandLog()
+    : Params{}
+    , Data{}
+    , Speeds{}
+    , Accelerations{}
+    , Ticks{0}
+    , Hash{0}
+    , Pending{0}
+    , Offset{0}
+{
+}
+
+bool CommandLog::Save(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (file.fail())
+    {
+        SDL_Log("Failed to open command log: %s", path.string().data());
+        return false;
+    }
+    // a record changing no robot ends the stream, its run covers the unchanged ticks at the end
+    std::vector<uint8_t> end;
+    AppendVarint(end, Pending);
+    end.push_back(0);
+    file.write(kMagic, sizeof(kMagic));
+    Write(file, kVersion);
+    Write(file, Params.Seed);
+    Write(file, Params.Timestep);
+    Write(file, Params.Duration);
+    Write(file, int32_t(Params.SubSteps));
+    Write(file, uint8_t(Params.Settle));
+    Write(file, uint8_t(Params.Physics));
+    Write(file, Ticks);
+    Write(file, Hash);
+    Write(file, uint32_t(Params.Robots.size()));
+    for (const std::string& name : Params.Robots)
+    {
+        Write(file, uint32_t(name.size()));
+        file.write(name.data(), name.size());
+    }
+    Write(file, uint32_t(Params.Teams.size()));
+    for (int team : Params.Teams)
+    {
+        Write(file, int32_t(team));
+    }
+    // empty without a layout
+    std::vector<uint8_t> map;
+    if (Params.Layout)
+    {
+        Params.Layout->Save(map);
+    }
+    Write(file, uint64_t(map.size()));
+    file.write(reinterpret_cast<const char*>(map.data()), map.size());
+    Write(file, uint64_t(Data.size() + end.size()));
+    file.write(reinterpret_cast<const char*>(Data.data()), Data.size());
+    file.write(reinterpret_cast<const char*>(end.data()), end.size());
+    if (file.fail())
+    {
+        SDL_Log("Failed to write command log: %s", path.string().data());
+        return false;
+    }
+    return true;
+}
+
+bool CommandLog::Load(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (file.fail())
+    {
+        SDL_Log("Failed to open command log: %s", path.string().data());
+        return false;
+    }
+    std::error_code error;
+    uint64_t limit = std::filesystem::file_size(path, error);
+    char magic[sizeof(kMagic)];
+    uint32_t version;
+    EngineParams params;
+    int32_t subSteps;
+    uint8_t settle;
+    uint8_t physics;
+    uint64_t ticks;
+    uint64_t hash;
+    uint32_t count;
+    file.read(magic, sizeof(magic));
+    if (file.fail() || std::memcmp(magic, kMagic, sizeof(kMagic)) || !Read(file, version) || version != kVersion ||
+        !Read(file, params.Seed) || !Read(file, params.Timestep) || !Read(file, params.Duration) ||
+        !Read(file, subSteps) || !Read(file, settle) || !Read(file, physics) || physics > uint8_t(PhysicsType::Batch) ||
+        !Read(file, ticks) || !Read(file, hash) || !Read(file, count) || count > kMaxRobots)
+    {
+        SDL_Log("Failed to parse command log: %s", path.string().data());
+        return false;
+    }
+    params.SubSteps = subSteps;
+    params.Settle = settle;
+    params.Physics = PhysicsType(physics);
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t size;
+        if (!Read(file, size) || size > limit)
+        {
+            SDL_Log("Failed to parse command log: %s", path.string().data());
+            return false;
+        }
+        std::string& name = params.Robots.emplace_back(size, '\0');
+        file.read(name.data(), size);
+    }
+    uint32_t teams;
+    if (!Read(file, teams) || teams > kMaxRobots)
+    {
+        SDL_Log("Failed to parse command log: %s", path.string().data());
+        return false;
+    }
+    for (int i = 0; i < teams; i++)
+    {
+        int32_t team;
+        if (!Read(file, team))
+        {
+            SDL_Log("Failed to parse command log: %s", path.string().data());
+            return false;
+        }
+        params.Teams.push_back(team);
+    }
+    uint64_t layout;
+    if (!Read(file, layout) || layout > limit)
+    {
+        SDL_Log("Failed to parse command log: %s", path.string().data());
+        return false;
+    }
+    if (layout)
+    {
+        std::vector<uint8_t> data(layout);
+        file.read(reinterpret_cast<char*>(data.data()), layout);
+        std::shared_ptr<Map> map = std::make_shared<Map>();
+        if (file.fail() || !map->Parse(data))
+        {
+            SDL_Log("Failed to parse command log: %s", path.string().data());
+            return false;
+        }
+        params.Layout = map;
+    }
+    uint64_t size;
+    if (!Read(file, size) || size > limit)
+    {
+        SDL_Log("Failed to parse command log: %s", path.string().data());
+        return false;
+    }
+    std::vector<uint8_t> data(size);
+    file.read(reinterpret_cast<char*>(data.data()), size);
+    if (file.fail())
+    {
+        SDL_Log("Failed to parse command log: %s", path.string().data());
+        return false;
+    }
+    Params = std::move(params);
+    Data = std::move(data);
+    Ticks = ticks;
+    Hash = hash;
+    Rewind();
+    return true;
+}
+
+const EngineParams& CommandLog::GetParams() const
+{
+    return Params;
+}
+
+uint64_t CommandLog::GetTicks() const
+{
+    return Ticks;
+}
+
+uint64_t CommandLog::GetHash() const
+{
+    return Hash;
+}
+
+void CommandLog::Begin(const EngineParams& params)
+{
+    Params = params;
+    Data.clear();
+    // every robot starts from a default context, so only commands that differ from it are written
+    crobots::RobotContext context;
+    Speeds.assign(params.Robots.size(), context.Speed);
+    Accelerations.assign(params.Robots.size(), context.Acceleration);
+    Ticks = 0;
+    Hash = 0;
+    Pending = 0;
+    Offset = 0;
+}
+
+void CommandLog::Record(const std::vector<Robot>& robots, uint64_t hash)
+{
+    Ticks++;
+    Hash = hash;
+    uint8_t changed = 0;
+    uint8_t fields[kMaxRobots]{};
+    for (int i = 0; i < robots.size(); i++)
+    {
+        // compared by bits so replays are exact down to the sign of zero
+        const crobots::RobotContext& context = *robots[i].Context;
+        if (std::bit_cast<uint32_t>(context.Speed) != std::bit_cast<uint32_t>(Speeds[i]))
+        {
+            fields[i] |= kSpeed;
+        }
+        if (std::bit_cast<uint32_t>(context.Acceleration) != std::bit_cast<uint32_t>(Accelerations[i]))
+        {
+            fields[i] |= kAcceleration;
+        }
+        changed |= uint8_t(bool(fields[i])) << i;
+    }
+    if (!changed)
+    {
+        Pending++;
+        return;
+    }
+    AppendVarint(Data, Pending);
+    Data.push_back(changed);
+    for (int i = 0; i < robots.size(); i++)
+    {
+        if (!fields[i])
+        {
+            continue;
+        }
+        const crobots::RobotContext& context = *robots[i].Context;
+        Data.push_back(fields[i]);
+        if (fields[i] & kSpeed)
+        {
+            Append(Data, context.Speed);
+            Speeds[i] = context.Speed;
+        }
+        if (fields[i] & kAcceleration)
+        {
+            Append(Data, context.Acceleration);
+            Accelerations[i] = context.Acceleration;
+        }
+    }
+    Pending = 0;
+}
+
+void CommandLog::Rewind()
+{
+    Offset = 0;
+    ReadPending();
+}
+
+void CommandLog::Apply(std::vector<Robot>& robots)
+{
+    if (Pending == kNever)
+    {
+        return;
+    }
+    if (Pending)
+    {
+        Pending--;
+        return;
+    }
+    uint8_t changed;
+    if (!Extract(Data, Offset, changed) || !changed)
+    {
+        Pending = kNever;
+        return;
+    }
+    for (int i = 0; i < robots.size(); i++)
+    {
+        if (!(changed & (1 << i)))
+        {
+            continue;
+        }
+        crobots::RobotContext& context = *robots[i].Context;
+        uint8_t fields;
+        if (!Extract(Data, Offset, fields) || ((fields & kSpeed) && !Extract(Data, Offset, context.Speed)) ||
+            ((fields & kAcceleration) && !Extract(Data, Offset, context.Acceleration)))
+        {
+            SDL_Log("Command log is truncated");
+            Pending = kNever;
+            return;
+        }
+    }
+    ReadPending();
+}
+
+void CommandLog::ReadPending()
+{
+    if (!ExtractVarint(Data, Offset, Pending))
+    {
+        Pending = kNever;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "engine.hpp"
+
+// the commands every robot in one match issued each tick, enough to re-drive the engine without loading
+// any robot code. ticks where nobody changed anything cost a few bits, so a whole match stays small
+class CommandLog
+{
+public:
+    CommandLog();
+    bool Save(const std::filesystem::path& path) const;
+    bool Load(const std::filesystem::path& path);
+    // engine settings and lineup the match was recorded with. Robots holds the recorded names
+    const EngineParams& GetParams() const;
+    uint64_t GetTicks() const;
+    // rolling state hash after the last recorded tick, 0 if the engine wasn't hashing
+    uint64_t GetHash() const;
+
+    // called by the engine as the recorded match is reset and after every tick of it
+    void Begin(const EngineParams& params);
+    void Record(const std::vector<Robot>& robots, uint64_t hash);
+    // called by the engine as the replayed match is reset and in place of robot updates
+    void Rewind();
+    void Apply(std::vector<Robot>& robots);
+
+private:
+    void ReadPending();
+
+    EngineParams Params;
+    std::vector<uint8_t> Data;
+    // last commands written, per robot
+    std::vector<float> Speeds;
+    std::vector<float> Accelerations;
+    uint64_t Ticks;
+    uint64_t Hash;
+    // unchanged ticks since the last record while recording, left before the next one while replaying
+    uint64_t Pending;
+    size_t Offset;
+};
\ No newline at end of file
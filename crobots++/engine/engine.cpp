@@ -4,20 +4,40 @@
 #include <crobots++/robot.hpp>
 #include <glm/glm.hpp>
 
-#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include <string_view>
-#include <vector>
 #include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "arena.hpp"
+#include "batch.hpp"
+#include "commands.hpp"
 #include "engine.hpp"
+#include "event.hpp"
+#include "map.hpp"
+#include "metrics.hpp"
+#include "module.hpp"
 
-static constexpr const char* kNewRobot = "NewRobot";
 static constexpr float kEpsilon = std::numeric_limits<float>::epsilon();
 static constexpr float kWidth = 20.0f;
 static constexpr float kP = 5.0f;
+static constexpr uint32_t kCheckpointVersion = 2;
+static constexpr uint64_t kHashBasis = 0xCBF29CE484222325ull;
+static constexpr uint64_t kHashPrime = 0x100000001B3ull;
 
-static constexpr b2Vec2 kSpawns[8] =
+static std::atomic<uint32_t> gMatches;
+
+static constexpr b2Vec2 kSpawns[kMaxRobots] =
 {
     {kWidth / 4 * 1, kWidth / 2 * 1},
     {kWidth / 4 * 3, kWidth / 2 * 1},
@@ -29,122 +49,719 @@ static constexpr b2Vec2 kSpawns[8] =
     {kWidth / 4 * 1, kWidth / 4 * 3},
 };
 
+// checkpoints never leave the process, so plain copies are enough
+template<typename T>
+static void Append(std::vector<uint8_t>& blob, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    blob.insert(blob.end(), bytes, bytes + sizeof(T));
+}
+
+static void Append(std::vector<uint8_t>& blob, const std::string& value)
+{
+    Append(blob, uint32_t(value.size()));
+    blob.insert(blob.end(), value.begin(), value.end());
+}
+
+template<typename T>
+static bool Extract(const std::vector<uint8_t>& blob, size_t& offset, T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (offset + sizeof(T) > blob.size())
+    {
+        return false;
+    }
+    std::memcpy(&value, blob.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+static bool Extract(const std::vector<uint8_t>& blob, size_t& offset, std::string& value)
+{
+    uint32_t size;
+    if (!Extract(blob, offset, size) || offset + size > blob.size())
+    {
+        return false;
+    }
+    value.assign(blob.begin() + offset, blob.begin() + offset + size);
+    offset += size;
+    return true;
+}
+
+static void Append(std::vector<uint8_t>& blob, const std::vector<crobots::Parameter>& parameters)
+{
+    Append(blob, uint32_t(parameters.size()));
+    for (const crobots::Parameter& parameter : parameters)
+    {
+        Append(blob, parameter.Name);
+        Append(blob, parameter.Value);
+        Append(blob, parameter.Min);
+        Append(blob, parameter.Max);
+    }
+}
+
+static bool Extract(const std::vector<uint8_t>& blob, size_t& offset, std::vector<crobots::Parameter>& parameters)
+{
+    uint32_t count;
+    if (!Extract(blob, offset, count) || count > blob.size() - offset)
+    {
+        return false;
+    }
+    parameters.resize(count);
+    for (crobots::Parameter& parameter : parameters)
+    {
+        if (!Extract(blob, offset, parameter.Name) || !Extract(blob, offset, parameter.Value) ||
+            !Extract(blob, offset, parameter.Min) || !Extract(blob, offset, parameter.Max))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GetSpawns(uint64_t seed, int count, b2Vec2* spawns)
+{
+    int order[kMaxRobots];
+    for (int i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+    // seed 0 keeps the lineup order, anything else shuffles which robot gets which spawn
+    if (seed)
+    {
+        uint64_t state = seed;
+        for (int i = count - 1; i > 0; i--)
+        {
+            std::swap(order[i], order[SDL_rand_r(&state, i + 1)]);
+        }
+    }
+    for (int i = 0; i < count; i++)
+    {
+        spawns[i] = kSpawns[order[i]];
+    }
+}
+
+std::shared_ptr<crobots::RobotContext[]> CreateContexts(int count, Arena* arena)
+{
+    if (arena)
+    {
+        return std::allocate_shared<crobots::RobotContext[]>(ArenaAllocator<crobots::RobotContext>{arena}, count);
+    }
+    return std::make_shared<crobots::RobotContext[]>(count);
+}
+
+int GetTeam(const std::vector<int>& teams, int robot)
+{
+    return robot < teams.size() ? teams[robot] : -1;
+}
+
+void DeliverMessages(crobots::RobotContext* const* contexts, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        contexts[i]->Incoming = 0;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        crobots::RobotContext& sender = *contexts[i];
+        for (int j = 0; j < sender.Outgoing; j++)
+        {
+            crobots::Message message = sender.Outbox[j];
+            message.Sender = i;
+            int recipient = sender.Recipients[j];
+            for (int k = 0; k < count; k++)
+            {
+                crobots::RobotContext& receiver = *contexts[k];
+                if (k == i || sender.Team == -1 || receiver.Team != sender.Team ||
+                    (recipient != crobots::kBroadcast && recipient != k) || receiver.Incoming == crobots::kInboxSize)
+                {
+                    continue;
+                }
+                receiver.Inbox[receiver.Incoming++] = message;
+            }
+        }
+        sender.Outgoing = 0;
+    }
+}
+
+void TickBatch(BatchWorld& world, Engine* engines, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!engines[i].IsOver())
+        {
+            engines[i].BeginTick();
+        }
+    }
+    world.Step();
+    // nothing between the halves changes whether a match is over
+    for (int i = 0; i < count; i++)
+    {
+        if (!engines[i].IsOver())
+        {
+            engines[i].EndTick();
+        }
+    }
+}
+
+void PlaceResults(std::vector<RobotResult>& results)
+{
+    for (RobotResult& a : results)
+    {
+        // robots that survived longer place higher, less damage breaks ties among survivors
+        a.Placement = 1;
+        for (const RobotResult& b : results)
+        {
+            if (b.Time > a.Time || (b.Time == a.Time && b.Damage < a.Damage))
+            {
+                a.Placement++;
+            }
+        }
+    }
+}
+
 EngineParams::EngineParams()
     : Robots{}
+    , Seed{0}
     , Timestep{0.016f}
+    , Duration{120.0f}
+    , SubSteps{4}
+    , Physics{PhysicsType::Box2D}
+    , Settle{true}
+    , Arena{false}
+    , Teams{}
+    , Layout{}
 {
 }
 
-Engine::Engine()
+TickProfile::TickProfile()
+    : Time{0}
+    , Physics{}
+    , Counters{}
+    , Updates{}
+{
+}
+
+State::State()
     : Robots{}
     , Projectiles{}
-    , SharedObjects{}
-    , WorldID{}
-    , ChainBodyID{}
+    , Segments{}
+    , Polygons{}
+    , Profile{}
+    , Ticks{0}
+    , Width{0.0f}
+    , Profiling{false}
+{
+}
+
+Engine::Engine()
+    : Memory{}
+    , Robots{}
+    , Projectiles{}
+    , Physics{}
+    , Type{PhysicsType::Box2D}
+    , Ticks{0}
+    , DebugBounds{}
+    , UseDebugBounds{false}
     , Debug{true}
+    , Profiling{false}
+    , Hashing{false}
+    , Hash{kHashBasis}
+    , Recording{nullptr}
+    , Replay{nullptr}
+    , ReplayCopy{}
+    , TickTime{0}
+    , TickStart{0}
+    , Stepped{false}
+    , Batch{nullptr}
+    , BatchMatch{0}
     , Timestep{0.0f}
+    , Duration{0.0f}
+    , SubSteps{0}
+    , Settle{false}
+    , Teams{}
+    , Layout{}
+    , Blocked{}
+    , Walls{}
+    , Match{0}
+    , Ended{false}
 {
 }
 
 bool Engine::Init(const EngineParams& params)
 {
-    if (params.Robots.size() < 2 || params.Robots.size() > 8)
+    return Configure(params) && Reset(params.Seed, params.Robots);
+}
+
+bool Engine::Configure(const EngineParams& params)
+{
+    if (params.Timestep < kEpsilon)
     {
-        SDL_Log("Must have between 2 and 8 (inclusive) robots: %d", params.Robots.size());
+        SDL_Log("Timestep must be greater than zero");
         return false;
     }
-    if (params.Timestep < kEpsilon)
+    if (params.SubSteps < 1)
     {
-        SDL_Log("Timestep must be greater than zero");
+        SDL_Log("Must have at least one substep: %d", params.SubSteps);
+        return false;
+    }
+    if (params.Arena && !Arena::IsInstalled())
+    {
+        SDL_Log("Arena allocator isn't installed");
         return false;
     }
     Timestep = params.Timestep;
-    for (const std::string& string : params.Robots)
+    Duration = params.Duration;
+    SubSteps = params.SubSteps;
+    Settle = params.Settle;
+    Teams = params.Teams;
+    Layout = params.Layout ? params.Layout : std::make_shared<const Map>();
+    Type = params.Physics;
+    if (Batch)
     {
-        Robot robot;
-        robot.Context = std::make_shared<crobots::RobotContext>();
-        robot.Interface.reset(Load(string, robot.Context));
-        if (!robot.Interface)
+        if (Type != PhysicsType::Batch)
         {
-            SDL_Log("Failed to load robot: %s", string.data());
+            SDL_Log("A batch world only runs the batch physics");
             return false;
         }
-        Robots.push_back(std::move(robot));
+        Physics = std::make_unique<BatchPhysics>(Batch, BatchMatch);
     }
+    else
     {
-        b2WorldDef worldDef = b2DefaultWorldDef();
-        worldDef.gravity.x = 0.0f;
-        worldDef.gravity.y = 0.0f;
-        WorldID = b2CreateWorld(&worldDef);
+        Physics = CreatePhysics(Type);
     }
-    int robotID = 0;
-    for (Robot& robot : Robots)
+    for (const b2Vec2& spawn : kSpawns)
+    {
+        for (float x : {-0.5f, 0.5f})
+        {
+            for (float y : {-0.5f, 0.5f})
+            {
+                if (Layout->IsSolid({spawn.x + x, spawn.y + y}, kWidth))
+                {
+                    SDL_Log("Map covers a spawn point: %f, %f", spawn.x, spawn.y);
+                    return false;
+                }
+            }
+        }
+    }
+    // sized to the lineup, a later Reset with more robots grows it
+    Robots.reserve(params.Robots.size());
+    if (params.Arena)
     {
-        b2BodyDef bodyDef = b2DefaultBodyDef();
-        bodyDef.type = b2_dynamicBody;
-        bodyDef.position = kSpawns[robotID];
-        bodyDef.rotation = b2MakeRot(0.0f);
-        robot.BodyID = b2CreateBody(WorldID, &bodyDef);
-        b2ShapeDef shapeDef = b2DefaultShapeDef();
-        b2Polygon polygon = b2MakeBox(0.5f, 0.5f);
-        b2CreatePolygonShape(robot.BodyID, &shapeDef, &polygon);
-        b2Body_EnableHitEvents(robot.BodyID, true);
-        b2Body_EnableContactEvents(robot.BodyID, true);
-        robotID++;
-    }
-    {
-        b2BodyDef bodyDef = b2DefaultBodyDef();
-        bodyDef.type = b2_staticBody;
-        bodyDef.position = {0.0f, 0.0f};
-        ChainBodyID = b2CreateBody(WorldID, &bodyDef);
-        b2Vec2 points[4] =
-        {
-            {0.0f, 0.0f},
-            {0.0f, kWidth},
-            {kWidth, kWidth},
-            {kWidth, 0.0f}
-        };
-        b2SurfaceMaterial materials[4]{};
-        for (int i = 0; i < 4; i++)
-        {
-            materials[i].friction = 0.0f;
-            materials[i].restitution = 1.0f;
-        }
-        b2ChainDef chainDef = b2DefaultChainDef();
-        chainDef.points = points;
-        chainDef.count = 4;
-        chainDef.materials = materials;
-        chainDef.materialCount = 4;
-        chainDef.isLoop = true;
-        b2CreateChain(ChainBodyID, &chainDef);
-        b2Body_EnableHitEvents(ChainBodyID, true);
-        b2Body_EnableContactEvents(ChainBodyID, true);
+        // the world is created by Reset, inside the arena
+        Memory = std::make_unique<Arena>();
+        return true;
+    }
+    return CreateWorld();
+}
+
+bool Engine::CreateWorld()
+{
+    if (!Physics->CreateWorld(*Layout, kWidth))
+    {
+        SDL_Log("Failed to create physics world");
+        return false;
     }
     return true;
 }
 
 void Engine::Destroy()
 {
-    b2DestroyWorld(WorldID);
+    ArenaScope scope{Memory.get()};
+    if (Physics)
+    {
+        Physics->DestroyWorld();
+    }
     Robots.clear();
     Projectiles.clear();
-    for (SDL_SharedObject* object : SharedObjects)
+    Memory.reset();
+}
+
+bool Engine::Reset(uint64_t seed, const std::vector<std::string>& lineup)
+{
+    if (!CreateRobots(seed, lineup))
     {
-        SDL_UnloadObject(object);
+        return false;
+    }
+    Ticks = 0;
+    Hash = kHashBasis;
+    if (Recording)
+    {
+        EngineParams params;
+        params.Robots = lineup;
+        params.Seed = seed;
+        params.Timestep = Timestep;
+        params.Duration = Duration;
+        params.SubSteps = SubSteps;
+        params.Settle = Settle;
+        params.Physics = Type;
+        params.Teams = Teams;
+        params.Layout = Layout;
+        Recording->Begin(params);
+    }
+    if (Replay)
+    {
+        Replay->Rewind();
+    }
+    Match = ++gMatches;
+    Ended = false;
+    Emit(EventType::MatchStart, kNoRobot, kNoRobot, {0.0f, 0.0f}, float(Robots.size()));
+    return true;
+}
+
+bool Engine::CreateRobots(uint64_t seed, const std::vector<std::string>& lineup)
+{
+    if (lineup.size() < 2 || lineup.size() > kMaxRobots)
+    {
+        SDL_Log("Must have between 2 and 8 (inclusive) robots: %d", lineup.size());
+        return false;
+    }
+    if (Replay && Replay->GetParams().Robots.size() != lineup.size())
+    {
+        SDL_Log("Lineup doesn't match the command log: %d", lineup.size());
+        return false;
+    }
+    ArenaScope scope{Memory.get()};
+    if (Memory)
+    {
+        // nothing is kept between matches, the old world is released with the arena in one go
+        Physics->DestroyWorld();
+        Robots.clear();
+        Projectiles.clear();
+        Memory->Reset();
+        if (!CreateWorld())
+        {
+            return false;
+        }
+    }
+    b2Vec2 spawns[kMaxRobots];
+    GetSpawns(seed, lineup.size(), spawns);
+    DestroyProjectiles();
+    int first = Robots.size();
+    std::shared_ptr<crobots::RobotContext[]> contexts;
+    if (first < lineup.size())
+    {
+        contexts = CreateContexts(lineup.size() - first, Memory.get());
+    }
+    while (Robots.size() > lineup.size())
+    {
+        Physics->DestroyBody(Robots.back().BodyID);
+        Robots.pop_back();
+    }
+    for (int i = 0; i < lineup.size(); i++)
+    {
+        if (i == Robots.size())
+        {
+            Robot& robot = Robots.emplace_back();
+            robot.Context = std::shared_ptr<crobots::RobotContext>(contexts, &contexts[i - first]);
+            robot.BodyID = Physics->CreateBody(BodyType::Robot, {spawns[i], b2MakeRot(0.0f)}, {0.0f, 0.0f});
+        }
+        Robot& robot = Robots[i];
+        // the old interface may belong to the context being reset so release it first
+        robot.Interface.reset();
+        *robot.Context = crobots::RobotContext{};
+        Physics->SetTransform(robot.BodyID, {spawns[i], b2MakeRot(0.0f)});
+        Physics->SetLinearVelocity(robot.BodyID, {0.0f, 0.0f});
+        Physics->SetAngularVelocity(robot.BodyID, 0.0f);
+        Physics->SetAwake(robot.BodyID, true);
+        robot.Context->X = spawns[i].x;
+        robot.Context->Y = spawns[i].y;
+        robot.Context->Index = i;
+        robot.Context->Team = GetTeam(Teams, i);
+        robot.Ticks = 0;
+        robot.UpdateTime = 0;
+        robot.DamageDealt = 0.0f;
+        robot.Speed = 0.0f;
+        robot.Name = lineup[i];
+        robot.Metric = Metrics::GetRobot(lineup[i]);
+        if (Replay)
+        {
+            continue;
+        }
+        robot.Interface.reset(ModuleRegistry::Create(lineup[i], robot.Context));
+        if (!robot.Interface)
+        {
+            Metrics::Add(MetricCounter::Failures);
+            SDL_Log("Failed to load robot: %s", lineup[i].data());
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+void Engine::Visit(T&& visitor) const
+{
+    for (int i = 0; i < Robots.size(); i++)
+    {
+        const Robot& robot = Robots[i];
+        const crobots::RobotContext& context = *robot.Context;
+        b2Transform transform = Physics->GetTransform(robot.BodyID);
+        b2Vec2 linearVelocity = Physics->GetLinearVelocity(robot.BodyID);
+        visitor("robot[%d].position.x", i, 0, transform.p.x);
+        visitor("robot[%d].position.y", i, 0, transform.p.y);
+        visitor("robot[%d].rotation.c", i, 0, transform.q.c);
+        visitor("robot[%d].rotation.s", i, 0, transform.q.s);
+        visitor("robot[%d].velocity.x", i, 0, linearVelocity.x);
+        visitor("robot[%d].velocity.y", i, 0, linearVelocity.y);
+        visitor("robot[%d].angular_velocity", i, 0, Physics->GetAngularVelocity(robot.BodyID));
+        visitor("robot[%d].awake", i, 0, float(Physics->IsAwake(robot.BodyID)));
+        visitor("robot[%d].ticks", i, 0, float(robot.Ticks));
+        visitor("robot[%d].damage_dealt", i, 0, robot.DamageDealt);
+        visitor("robot[%d].driven_speed", i, 0, robot.Speed);
+        visitor("robot[%d].context.x", i, 0, context.X);
+        visitor("robot[%d].context.y", i, 0, context.Y);
+        visitor("robot[%d].context.speed", i, 0, context.Speed);
+        visitor("robot[%d].context.acceleration", i, 0, context.Acceleration);
+        visitor("robot[%d].context.damage", i, 0, context.Damage);
+        visitor("robot[%d].context.time", i, 0, context.Time);
+        visitor("robot[%d].context.index", i, 0, float(context.Index));
+        visitor("robot[%d].context.team", i, 0, float(context.Team));
+        // filled in by robot code, which a replay doesn't run, so a log covers only what the engine reproduces
+        if (!Recording && !Replay)
+        {
+            visitor("robot[%d].context.parameters", i, 0, float(context.Parameters.size()));
+            for (int j = 0; j < context.Parameters.size(); j++)
+            {
+                visitor("robot[%d].context.parameter[%d]", i, j, context.Parameters[j].Value);
+            }
+            visitor("robot[%d].context.overrides", i, 0, float(context.Overrides.size()));
+            for (int j = 0; j < context.Overrides.size(); j++)
+            {
+                visitor("robot[%d].context.override[%d]", i, j, context.Overrides[j].Value);
+            }
+            visitor("robot[%d].context.outgoing", i, 0, float(context.Outgoing));
+            visitor("robot[%d].context.incoming", i, 0, float(context.Incoming));
+            for (int j = 0; j < context.Incoming; j++)
+            {
+                const crobots::Message& message = context.Inbox[j];
+                constexpr int kData = sizeof(crobots::Message::Data) / sizeof(float);
+                visitor("robot[%d].context.inbox[%d].sender", i, j, float(message.Sender));
+                for (int k = 0; k < kData; k++)
+                {
+                    // flattened since names only carry two indices
+                    visitor("robot[%d].context.inbox.data[%d]", i, j * kData + k, message.Data[k]);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < Projectiles.size(); i++)
+    {
+        b2Transform transform = Physics->GetTransform(Projectiles[i].BodyID);
+        b2Vec2 linearVelocity = Physics->GetLinearVelocity(Projectiles[i].BodyID);
+        visitor("projectile[%d].position.x", i, 0, transform.p.x);
+        visitor("projectile[%d].position.y", i, 0, transform.p.y);
+        visitor("projectile[%d].velocity.x", i, 0, linearVelocity.x);
+        visitor("projectile[%d].velocity.y", i, 0, linearVelocity.y);
     }
 }
 
 void Engine::Tick()
 {
+    BeginTick();
+    EndTick();
+}
+
+void Engine::BeginTick()
+{
+    ArenaScope scope{Memory.get()};
+    // timing is opt in since reading the clock per robot adds up over a tournament
+    TickStart = Profiling ? SDL_GetTicksNS() : 0;
+    bool timing = Profiling || Metrics::IsEnabled();
+    // even without robots to read them, so a replay still costs what the match did
+    Sight();
+    if (Replay)
+    {
+        // commands go straight into the contexts, no robot code runs
+        Replay->Apply(Robots);
+    }
+    else
+    {
+        for (Robot& robot : Robots)
+        {
+            if (timing)
+            {
+                uint64_t time = SDL_GetTicksNS();
+                robot.Interface->Update(Timestep);
+                robot.UpdateTime = SDL_GetTicksNS() - time;
+                Metrics::Observe(robot.Metric, robot.UpdateTime);
+            }
+            else
+            {
+                robot.Interface->Update(Timestep);
+            }
+        }
+        crobots::RobotContext* contexts[kMaxRobots];
+        for (int i = 0; i < Robots.size(); i++)
+        {
+            contexts[i] = Robots[i].Context.get();
+        }
+        DeliverMessages(contexts, Robots.size());
+    }
+    // nothing can move or take damage until a robot is commanded to, so a settled world skips physics entirely
+    bool settled = Settle && Projectiles.empty();
+    for (const Robot& robot : Robots)
+    {
+        if (robot.Speed != robot.Context->Speed || Physics->IsAwake(robot.BodyID))
+        {
+            settled = false;
+            break;
+        }
+    }
+    Stepped = !settled;
+    if (Stepped)
+    {
+        Step();
+    }
+}
+
+void Engine::EndTick()
+{
+    ArenaScope scope{Memory.get()};
+    if (Stepped)
+    {
+        Collide();
+    }
+    Ticks++;
+    Metrics::Add(MetricCounter::Ticks);
     for (Robot& robot : Robots)
     {
-        robot.Interface->Update(Timestep);
+        robot.Context->Time = Ticks * Timestep;
+        if (robot.Context->Damage < kMaxDamage)
+        {
+            robot.Ticks = Ticks;
+        }
+        else if (robot.Ticks == Ticks - 1)
+        {
+            Emit(EventType::Kill, &robot - Robots.data(), kNoRobot, Physics->GetTransform(robot.BodyID).p,
+                robot.Context->Damage);
+        }
+    }
+    if (!Ended && EventLog::IsOpen() && IsOver())
+    {
+        Ended = true;
+        int alive = 0;
+        for (const Robot& robot : Robots)
+        {
+            alive += robot.Context->Damage < kMaxDamage;
+        }
+        Emit(EventType::MatchEnd, kNoRobot, kNoRobot, {0.0f, 0.0f}, float(alive));
     }
+    if (Hashing)
+    {
+        // fnv-1a over the raw bits, so -0 and 0 or two nans with different payloads still count as different
+        uint64_t hash = Hash ^ Ticks;
+        Visit([&hash](const char* name, int index, int element, float value)
+        {
+            hash = (hash ^ std::bit_cast<uint32_t>(value)) * kHashPrime;
+        });
+        Hash = hash;
+    }
+    // after physics, which only reads commands, so the hash recorded is the one for this tick
+    if (Recording)
+    {
+        Recording->Record(Robots, Hashing ? Hash : 0);
+    }
+    if (Profiling)
+    {
+        TickTime = SDL_GetTicksNS() - TickStart;
+    }
+}
+
+void Engine::Sight()
+{
+    for (Robot& robot : Robots)
+    {
+        robot.Context->Visible = 0;
+    }
+    auto see = [this](int i, int j)
+    {
+        crobots::RobotContext& a = *Robots[i].Context;
+        crobots::RobotContext& b = *Robots[j].Context;
+        a.Sightings[a.Visible++] = {b.X, b.Y};
+        b.Sightings[b.Visible++] = {a.X, a.Y};
+    };
+    Blocked.clear();
+    for (int i = 0; i < Robots.size(); i++)
+    {
+        const crobots::RobotContext& a = *Robots[i].Context;
+        if (a.Damage >= kMaxDamage)
+        {
+            continue;
+        }
+        for (int j = i + 1; j < Robots.size(); j++)
+        {
+            const crobots::RobotContext& b = *Robots[j].Context;
+            if (b.Damage >= kMaxDamage)
+            {
+                continue;
+            }
+            // most pairs are settled by the grid alone, only the ones near a wall need a ray
+            if (Layout->IsClear({a.X, a.Y}, {b.X, b.Y}, kWidth))
+            {
+                see(i, j);
+            }
+            else
+            {
+                Blocked.emplace_back(i, j);
+            }
+        }
+    }
+    if (Blocked.empty())
+    {
+        return;
+    }
+    // one broadphase query gathers every wall any blocked pair could cross, then each ray is tested against
+    // just those segments instead of walking the tree once per pair
+    b2AABB bounds{{kWidth, kWidth}, {0.0f, 0.0f}};
+    for (const auto& [i, j] : Blocked)
+    {
+        for (int k : {i, j})
+        {
+            b2Vec2 point{Robots[k].Context->X, Robots[k].Context->Y};
+            bounds.lowerBound = b2Min(bounds.lowerBound, point);
+            bounds.upperBound = b2Max(bounds.upperBound, point);
+        }
+    }
+    Walls.clear();
+    Physics->GetWalls(bounds, Walls);
+    for (const auto& [i, j] : Blocked)
+    {
+        const crobots::RobotContext& a = *Robots[i].Context;
+        const crobots::RobotContext& b = *Robots[j].Context;
+        b2RayCastInput input{{a.X, a.Y}, {b.X - a.X, b.Y - a.Y}, 1.0f};
+        b2AABB ray{b2Min(input.origin, {b.X, b.Y}), b2Max(input.origin, {b.X, b.Y})};
+        bool hit = false;
+        for (const b2Segment& wall : Walls)
+        {
+            b2AABB box{b2Min(wall.point1, wall.point2), b2Max(wall.point1, wall.point2)};
+            if (b2AABB_Overlaps(ray, box) && b2RayCastSegment(&input, &wall, false).hit)
+            {
+                hit = true;
+                break;
+            }
+        }
+        if (!hit)
+        {
+            see(i, j);
+        }
+    }
+}
+
+void Engine::Step()
+{
     for (Robot& robot : Robots)
     {
-        b2Vec2 linearVelocity = b2Body_GetLinearVelocity(robot.BodyID);
-        b2Rot rotation = b2Body_GetRotation(robot.BodyID);
-        float mass = b2Body_GetMass(robot.BodyID);
+        // leave sleeping bodies alone unless their command changed. collisions wake them on their own
+        if (robot.Speed == robot.Context->Speed && !Physics->IsAwake(robot.BodyID))
+        {
+            continue;
+        }
+        robot.Speed = robot.Context->Speed;
+        b2Vec2 linearVelocity = Physics->GetLinearVelocity(robot.BodyID);
+        b2Rot rotation = Physics->GetTransform(robot.BodyID).q;
+        float mass = Physics->GetMass(robot.BodyID);
         glm::vec2 velocity;
         velocity.x = rotation.c;
         velocity.y = rotation.s;
@@ -158,61 +775,170 @@ void Engine::Tick()
         {
             force *= maxForce / glm::length(force);
         }
-        b2Body_ApplyForceToCenter(robot.BodyID, {force.x, force.y}, true);
+        Physics->ApplyForce(robot.BodyID, {force.x, force.y});
     }
-    b2World_Step(WorldID, Timestep, 4);
-    b2ContactEvents contactEvents = b2World_GetContactEvents(WorldID);
-    for (int i = 0; i < contactEvents.hitCount; i++)
+    Physics->Step(Timestep, SubSteps);
+}
+
+void Engine::Collide()
+{
+    for (const Contact& contact : Physics->GetContacts())
     {
-        b2ContactHitEvent& event = contactEvents.hitEvents[i];
-        b2BodyId body1 = b2Shape_GetBody(event.shapeIdA);
-        b2BodyId body2 = b2Shape_GetBody(event.shapeIdB);
-        auto update = [](b2BodyId body)
+        if (contact.Hit)
         {
-            b2Vec2 position = b2Body_GetPosition(body);
-            b2Vec2 linearVelocity = b2Body_GetLinearVelocity(body);
-            glm::vec2 velocity;
-            velocity.x = linearVelocity.x;
-            velocity.y = linearVelocity.y;
-            if (glm::length(velocity) < kEpsilon)
+            if (EventLog::IsOpen())
             {
-                return;
+                Emit(EventType::Collision, GetRobot(contact.BodyA), GetRobot(contact.BodyB), contact.Point,
+                    contact.ApproachSpeed);
+            }
+            auto update = [this](int body)
+            {
+                b2Transform transform = Physics->GetTransform(body);
+                b2Vec2 linearVelocity = Physics->GetLinearVelocity(body);
+                glm::vec2 velocity;
+                velocity.x = linearVelocity.x;
+                velocity.y = linearVelocity.y;
+                if (glm::length(velocity) < kEpsilon)
+                {
+                    return;
+                }
+                velocity = glm::normalize(velocity);
+                transform.q.c = velocity.x;
+                transform.q.s = velocity.y;
+                Physics->SetTransform(body, transform);
+            };
+            if (contact.BodyA == kNoBody)
+            {
+                update(contact.BodyB);
+            }
+            else if (contact.BodyB == kNoBody)
+            {
+                update(contact.BodyA);
             }
-            velocity = glm::normalize(velocity);
-            b2Rot rotation;
-            rotation.c = velocity.x;
-            rotation.s = velocity.y;
-            b2Body_SetTransform(body, position, rotation);
-        };
-        if (B2_ID_EQUALS(body1, ChainBodyID))
-        {
-            update(body2);
         }
-        else if (B2_ID_EQUALS(body2, ChainBodyID))
+        for (int body : {contact.BodyA, contact.BodyB})
         {
-            update(body1);
+            if (body != kNoBody)
+            {
+                Physics->SetAngularVelocity(body, 0.0f);
+            }
         }
-        b2Body_SetAngularVelocity(body1, 0.0f);
-        b2Body_SetAngularVelocity(body2, 0.0f);
     }
-    for (int i = 0; i < contactEvents.endCount; i++)
+    for (Robot& robot : Robots)
+    {
+        b2Vec2 position = Physics->GetTransform(robot.BodyID).p;
+        robot.Context->X = position.x;
+        robot.Context->Y = position.y;
+    }
+}
+
+uint8_t Engine::GetRobot(int body) const
+{
+    for (int i = 0; i < Robots.size(); i++)
     {
-        b2ContactEndTouchEvent& event = contactEvents.endEvents[i];
-        if (!b2Shape_IsValid(event.shapeIdA) || !b2Shape_IsValid(event.shapeIdB))
+        if (Robots[i].BodyID == body)
         {
-            continue;
+            return i;
         }
-        b2BodyId body1 = b2Shape_GetBody(event.shapeIdA);
-        b2BodyId body2 = b2Shape_GetBody(event.shapeIdB);
-        b2Body_SetAngularVelocity(body1, 0.0f);
-        b2Body_SetAngularVelocity(body2, 0.0f);
     }
-    for (Robot& robot : Robots)
+    return kNoRobot;
+}
+
+void Engine::Emit(EventType type, uint8_t robot, uint8_t other, const b2Vec2& position, float value) const
+{
+    if (!EventLog::IsOpen())
     {
-        b2Vec2 position = b2Body_GetPosition(robot.BodyID);
-        robot.Context->X = position.x;
-        robot.Context->Y = position.y;
+        return;
+    }
+    Event event{};
+    event.Tick = Ticks;
+    event.Match = Match;
+    event.Type = type;
+    event.Robot = robot;
+    event.Other = other;
+    event.X = position.x;
+    event.Y = position.y;
+    event.Value = value;
+    if (robot != kNoRobot)
+    {
+        event.Angle = b2Rot_GetAngle(Physics->GetTransform(Robots[robot].BodyID).q);
+    }
+    EventLog::Write(event);
+}
+
+bool Engine::IsOver() const
+{
+    if (Duration > kEpsilon && Ticks * Timestep >= Duration)
+    {
+        return true;
+    }
+    int alive = 0;
+    for (const Robot& robot : Robots)
+    {
+        alive += robot.Context->Damage < kMaxDamage;
     }
+    return alive <= 1;
+}
+
+void Engine::GetResults(std::vector<RobotResult>& results) const
+{
+    results.resize(Robots.size());
+    for (int i = 0; i < Robots.size(); i++)
+    {
+        results[i].Damage = Robots[i].Context->Damage;
+        results[i].DamageDealt = Robots[i].DamageDealt;
+        results[i].Time = Robots[i].Ticks * Timestep;
+    }
+    PlaceResults(results);
+}
+
+void Engine::GetState(State& state) const
+{
+    state.Robots.clear();
+    state.Projectiles.clear();
+    state.Segments.clear();
+    state.Polygons.clear();
+    for (const Robot& robot : Robots)
+    {
+        RobotState& robotState = state.Robots.emplace_back();
+        b2Transform transform = Physics->GetTransform(robot.BodyID);
+        robotState.Position = transform.p;
+        robotState.Rotation = transform.q;
+    }
+    for (const Projectile& projectile : Projectiles)
+    {
+        ProjectileState& projectileState = state.Projectiles.emplace_back();
+        projectileState.Position = Physics->GetTransform(projectile.BodyID).p;
+    }
+    if (Debug)
+    {
+        Physics->Draw(state, UseDebugBounds ? &DebugBounds : nullptr);
+    }
+    state.Profiling = Profiling;
+    if (Profiling)
+    {
+        state.Profile.Time = TickTime;
+        Physics->GetProfile(state.Profile);
+        state.Profile.Updates.clear();
+        for (const Robot& robot : Robots)
+        {
+            state.Profile.Updates.push_back(robot.UpdateTime);
+        }
+    }
+    state.Ticks = Ticks;
+    state.Width = kWidth;
+}
+
+void Engine::SetParameter(int robot, const std::string_view& name, float value)
+{
+    crobots::Parameter& parameter = Robots[robot].Context->Overrides.emplace_back();
+    parameter.Name = name;
+    parameter.Value = value;
+}
+
+const std::vector<crobots::Parameter>& Engine::GetParameters(int robot) const
+{
+    return Robots[robot].Context->Parameters;
 }
 
 const std::vector<Robot>& Engine::GetRobots() const
@@ -225,9 +951,19 @@ const std::vector<Projectile> Engine::GetProjectiles() const
     return Projectiles;
 }
 
-b2WorldId Engine::GetWorldID() const
+crobots::RobotContext& Engine::GetContext(int robot)
 {
-    return WorldID;
+    return *Robots[robot].Context;
+}
+
+b2Vec2 Engine::GetVelocity(int robot) const
+{
+    return Physics->GetLinearVelocity(Robots[robot].BodyID);
+}
+
+b2Rot Engine::GetRotation(int robot) const
+{
+    return Physics->GetTransform(Robots[robot].BodyID).q;
 }
 
 float Engine::GetWidth() const
@@ -240,43 +976,297 @@ void Engine::SetDebug(bool debug)
     Debug = debug;
 }
 
+void Engine::SetDebugBounds(const b2AABB& bounds)
+{
+    DebugBounds = bounds;
+    UseDebugBounds = true;
+}
+
+float Engine::GetTimestep() const
+{
+    return Timestep;
+}
+
+uint64_t Engine::GetTicks() const
+{
+    return Ticks;
+}
+
 bool Engine::GetDebug() const
 {
+    return Debug;
+}
+
+void Engine::SetProfiling(bool profiling)
+{
+    Profiling = profiling;
+}
+
+bool Engine::GetProfiling() const
+{
+    return Profiling;
+}
+
+void Engine::SetHashing(bool hashing)
+{
+    Hashing = hashing;
+}
+
+bool Engine::GetHashing() const
+{
+    return Hashing;
+}
+
+uint64_t Engine::GetHash() const
+{
+    return Hash;
+}
+
+void Engine::GetFields(std::vector<StateField>& fields) const
+{
+    fields.clear();
+    Visit([&fields](const char* name, int index, int element, float value)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), name, index, element);
+        fields.emplace_back(buffer, value);
+    });
+}
+
+void Engine::SetRecording(CommandLog* log)
+{
+    Recording = log;
+}
+
+void Engine::SetReplay(CommandLog* log)
+{
+    Replay = log;
+}
+
+void Engine::SetBatch(BatchWorld* world, int match)
+{
+    Batch = world;
+    BatchMatch = match;
+}
+
+uint64_t Engine::GetFootprint() const
+{
+    uint64_t bytes = sizeof(Engine) + Robots.capacity() * sizeof(Robot) + Projectiles.capacity() * sizeof(Projectile);
+    bytes += Teams.capacity() * sizeof(int) + Blocked.capacity() * sizeof(std::pair<int, int>) +
+        Walls.capacity() * sizeof(b2Segment);
+    for (const Robot& robot : Robots)
+    {
+        // short names live inside the string
+        if (robot.Name.capacity() > std::string{}.capacity())
+        {
+            bytes += robot.Name.capacity() + 1;
+        }
+        bytes += sizeof(crobots::RobotContext);
+        bytes += (robot.Context->Parameters.capacity() + robot.Context->Overrides.capacity()) * sizeof(crobots::Parameter);
+    }
+    return bytes;
+}
+
+bool Engine::GetMemory(ArenaStats& stats) const
+{
+    if (!Memory)
+    {
+        return false;
+    }
+    stats = Memory->GetStats();
+    return true;
+}
+
+void Engine::Checkpoint(std::vector<uint8_t>& blob) const
+{
+    blob.clear();
+    Append(blob, kCheckpointVersion);
+    Append(blob, Ticks);
+    Append(blob, uint32_t(Robots.size()));
+    for (const Robot& robot : Robots)
+    {
+        const crobots::RobotContext& context = *robot.Context;
+        Append(blob, robot.Name);
+        Append(blob, Physics->GetTransform(robot.BodyID));
+        Append(blob, Physics->GetLinearVelocity(robot.BodyID));
+        Append(blob, Physics->GetAngularVelocity(robot.BodyID));
+        Append(blob, Physics->IsAwake(robot.BodyID));
+        Append(blob, robot.Ticks);
+        Append(blob, robot.DamageDealt);
+        Append(blob, robot.Speed);
+        Append(blob, context.X);
+        Append(blob, context.Y);
+        Append(blob, context.Speed);
+        Append(blob, context.Acceleration);
+        Append(blob, context.Damage);
+        Append(blob, context.Time);
+        Append(blob, context.Parameters);
+        Append(blob, context.Overrides);
+        Append(blob, context.Index);
+        Append(blob, context.Team);
+        // outboxes are always empty between ticks
+        Append(blob, context.Incoming);
+        Append(blob, context.Inbox);
+    }
+    Append(blob, uint32_t(Projectiles.size()));
+    for (const Projectile& projectile : Projectiles)
+    {
+        Append(blob, Physics->GetTransform(projectile.BodyID));
+        Append(blob, Physics->GetLinearVelocity(projectile.BodyID));
+    }
+}
+
+bool Engine::Restore(const std::vector<uint8_t>& blob)
+{
+    size_t offset = 0;
+    uint32_t version;
+    uint64_t ticks;
+    uint32_t count;
+    if (!Extract(blob, offset, version) || version != kCheckpointVersion || !Extract(blob, offset, ticks) ||
+        !Extract(blob, offset, count) || count != Robots.size())
+    {
+        SDL_Log("Checkpoint doesn't match the engine");
+        return false;
+    }
+    // parse everything before touching the world so a bad blob leaves the match as it was
+    struct Body
+    {
+        b2Transform Transform;
+        b2Vec2 LinearVelocity;
+        float AngularVelocity;
+        bool Awake;
+        uint64_t Ticks;
+        float DamageDealt;
+        float Speed;
+    };
+    std::vector<Body> bodies(count);
+    std::vector<crobots::RobotContext> contexts(count);
+    for (int i = 0; i < count; i++)
+    {
+        Body& body = bodies[i];
+        crobots::RobotContext& context = contexts[i];
+        std::string name;
+        if (!Extract(blob, offset, name) || name != Robots[i].Name ||
+            !Extract(blob, offset, body.Transform) || !Extract(blob, offset, body.LinearVelocity) ||
+            !Extract(blob, offset, body.AngularVelocity) || !Extract(blob, offset, body.Awake) ||
+            !Extract(blob, offset, body.Ticks) || !Extract(blob, offset, body.DamageDealt) ||
+            !Extract(blob, offset, body.Speed) || !Extract(blob, offset, context.X) ||
+            !Extract(blob, offset, context.Y) || !Extract(blob, offset, context.Speed) ||
+            !Extract(blob, offset, context.Acceleration) || !Extract(blob, offset, context.Damage) ||
+            !Extract(blob, offset, context.Time) || !Extract(blob, offset, context.Parameters) ||
+            !Extract(blob, offset, context.Overrides) || !Extract(blob, offset, context.Index) ||
+            !Extract(blob, offset, context.Team) || !Extract(blob, offset, context.Incoming) ||
+            context.Incoming < 0 || context.Incoming > crobots::kInboxSize || !Extract(blob, offset, context.Inbox))
+        {
+            SDL_Log("Checkpoint doesn't match the engine");
+            return false;
+        }
+    }
+    uint32_t projectiles;
+    if (!Extract(blob, offset, projectiles) || projectiles > blob.size() - offset)
+    {
+        SDL_Log("Failed to parse checkpoint");
+        return false;
+    }
+    std::vector<std::pair<b2Transform, b2Vec2>> transforms(projectiles);
+    for (auto& [transform, velocity] : transforms)
+    {
+        if (!Extract(blob, offset, transform) || !Extract(blob, offset, velocity))
+        {
+            SDL_Log("Failed to parse checkpoint");
+            return false;
+        }
+    }
+    if (offset != blob.size())
+    {
+        SDL_Log("Failed to parse checkpoint");
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        Robot& robot = Robots[i];
+        const Body& body = bodies[i];
+        Physics->SetTransform(robot.BodyID, body.Transform);
+        Physics->SetLinearVelocity(robot.BodyID, body.LinearVelocity);
+        Physics->SetAngularVelocity(robot.BodyID, body.AngularVelocity);
+        Physics->SetAwake(robot.BodyID, body.Awake);
+        robot.Ticks = body.Ticks;
+        robot.DamageDealt = body.DamageDealt;
+        robot.Speed = body.Speed;
+        // assigned in place since the robot instance holds on to the context
+        *robot.Context = std::move(contexts[i]);
+    }
+    ArenaScope scope{Memory.get()};
+    DestroyProjectiles();
+    for (const auto& [transform, velocity] : transforms)
+    {
+        CreateProjectile(transform, velocity);
+    }
+    Ticks = ticks;
     return true;
 }
 
-crobots::IRobot* Engine::Load(const std::string_view& name, const std::shared_ptr<crobots::RobotContext>& context)
+bool Engine::Fork(Engine& engine) const
 {
-    std::filesystem::path path = SDL_GetBasePath();
-    path /= name;
-#if defined(SDL_PLATFORM_WIN32)
-    path.replace_extension(".dll");
-#elif defined(SDL_PLATFORM_LINUX)
-    path.replace_extension(".so");
-#elif defined(SDL_PLATFORM_APPLE)
-    path.replace_extension(".dylib");
-#endif
-    SDL_SharedObject* object = SDL_LoadObject(path.string().data());
-    if (!object)
+    EngineParams params;
+    for (const Robot& robot : Robots)
+    {
+        params.Robots.push_back(robot.Name);
+    }
+    params.Timestep = Timestep;
+    params.Duration = Duration;
+    params.SubSteps = SubSteps;
+    params.Settle = Settle;
+    params.Physics = Type;
+    params.Arena = Memory != nullptr;
+    params.Teams = Teams;
+    params.Layout = Layout;
+    if (!engine.Configure(params))
+    {
+        SDL_Log("Failed to initialize engine");
+        return false;
+    }
+    // a replay continues from the same place in its own copy of the log, so neither moves the other on and
+    // no robots are loaded
+    if (Replay)
     {
-        SDL_Log("Failed to load robot: %s, %s", path.string().data(), SDL_GetError());
-        return nullptr;
+        engine.ReplayCopy = std::make_shared<CommandLog>(*Replay);
+        engine.Replay = engine.ReplayCopy.get();
     }
-    using Function = crobots::IRobot*(*)(const std::shared_ptr<crobots::RobotContext>& context);
-    Function function = reinterpret_cast<Function>(SDL_LoadFunction(object, kNewRobot));
-    if (!function)
+    if (!engine.CreateRobots(0, params.Robots))
     {
-        SDL_Log("Failed to load %s: %s, %s", kNewRobot, name.data(), SDL_GetError());
-        SDL_UnloadObject(object);
-        return nullptr;
+        engine.Destroy();
+        return false;
     }
-    crobots::IRobot* robot = function(context);
-    if (!robot)
+    // the same match carrying on, so it isn't counted or announced again
+    engine.Match = Match;
+    engine.Ended = Ended;
+    engine.Debug = Debug;
+    engine.DebugBounds = DebugBounds;
+    engine.UseDebugBounds = UseDebugBounds;
+    engine.Hashing = Hashing;
+    engine.Hash = Hash;
+    std::vector<uint8_t> blob;
+    Checkpoint(blob);
+    if (!engine.Restore(blob))
     {
-        SDL_Log("Failed to create robot: %s, %s", name.data(), SDL_GetError());
-        SDL_UnloadObject(object);
-        return nullptr;
+        engine.Destroy();
+        return false;
     }
-    SharedObjects.push_back(object);
-    return robot;
+    return true;
+}
+
+void Engine::CreateProjectile(const b2Transform& transform, const b2Vec2& velocity)
+{
+    Projectile& projectile = Projectiles.emplace_back();
+    projectile.BodyID = Physics->CreateBody(BodyType::Projectile, transform, velocity);
+}
+
+void Engine::DestroyProjectiles()
+{
+    for (Projectile& projectile : Projectiles)
+    {
+        Physics->DestroyBody(projectile.BodyID);
+    }
+    Projectiles.clear();
 }
\ No newline at end of file
@@ -4,29 +4,96 @@
 #include <crobots++/internal.hpp>
 #include <crobots++/robot.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "arena.hpp"
+#include "event.hpp"
+#include "map.hpp"
+#include "physics.hpp"
+#include "state.hpp"
+
+static constexpr int kMaxRobots = 8;
+// a robot is out once it has taken this much
+static constexpr float kMaxDamage = 100.0f;
+
+class BatchWorld;
+class CommandLog;
+
 struct EngineParams
 {
     EngineParams();
 
     std::vector<std::string> Robots;
+    uint64_t Seed;
     float Timestep;
+    float Duration;
+    // box2d substeps per tick
+    int SubSteps;
+    // the backend the match runs on
+    PhysicsType Physics;
+    // skip physics on ticks where nothing can move
+    bool Settle;
+    // allocate each match from an arena and drop it whole on reset. needs Arena::Install
+    bool Arena;
+    // team of the robot in each lineup slot. robots past the end have no teammates
+    std::vector<int> Teams;
+    // walls and cover, nullptr for the empty arena
+    std::shared_ptr<const Map> Layout;
 };
 
 struct Robot
 {
+    std::string Name;
     std::unique_ptr<crobots::IRobot> Interface;
     std::shared_ptr<crobots::RobotContext> Context;
-    b2BodyId BodyID;
+    int BodyID;
+    uint64_t Ticks;
+    // nanoseconds spent in the last update, only measured while profiling
+    uint64_t UpdateTime;
+    float DamageDealt;
+    // speed the body was last driven at. a sleeping body is only woken when this changes
+    float Speed;
+    // update latency histogram, -1 unless metrics are enabled
+    int Metric;
+};
+
+struct RobotResult
+{
+    // 1 is first, tied robots share a placement
+    int Placement;
+    float Damage;
+    float DamageDealt;
+    float Time;
 };
 
+// one named value of the simulation, for telling where two runs part ways
+struct StateField
+{
+    std::string Name;
+    float Value;
+};
+
+// spawn points for a lineup of count robots
+void GetSpawns(uint64_t seed, int count, b2Vec2* spawns);
+// count contexts in one allocation, from the arena if there is one. hand them out with the aliasing
+// constructor so each robot's pointer keeps the whole block alive
+std::shared_ptr<crobots::RobotContext[]> CreateContexts(int count, Arena* arena);
+// team for a lineup slot, -1 if it has none
+int GetTeam(const std::vector<int>& teams, int robot);
+// empties every outbox of one match into its recipients' inboxes. senders go in lineup order, so what a
+// robot receives doesn't depend on which robot updated first or on which thread
+void DeliverMessages(crobots::RobotContext* const* contexts, int count);
+// ranks robots by time survived, then by damage taken. tied robots share a placement
+void PlaceResults(std::vector<RobotResult>& results);
+
 struct Projectile
 {
-    b2BodyId BodyID;
+    int BodyID;
 };
 
 class Engine
@@ -35,22 +102,117 @@ public:
     Engine();
     bool Init(const EngineParams& params);
     void Destroy();
+    bool Reset(uint64_t seed, const std::vector<std::string>& lineup);
     void Tick();
+    // Tick in two halves around the physics step, for engines whose matches share a batch world
+    void BeginTick();
+    void EndTick();
+    void GetState(State& state) const;
+    bool IsOver() const;
+    void GetResults(std::vector<RobotResult>& results) const;
+    // overrides only take effect between Reset and the first Tick
+    void SetParameter(int robot, const std::string_view& name, float value);
+    const std::vector<crobots::Parameter>& GetParameters(int robot) const;
+    // captures bodies, contexts, projectiles and the tick counter. robots' own members and box2d's contact
+    // cache aren't included, so a restored match is a close continuation rather than a bit exact one
+    void Checkpoint(std::vector<uint8_t>& blob) const;
+    // the lineup must match the one the checkpoint was taken from. robots keep their current instances
+    bool Restore(const std::vector<uint8_t>& blob);
+    // initializes an engine that isn't yet as a copy of this one, with fresh robot instances. the copy is the
+    // same match, so it isn't counted or announced again, and a replay carries on from the same tick
+    bool Fork(Engine& engine) const;
     const std::vector<Robot>& GetRobots() const;
     const std::vector<Projectile> GetProjectiles() const;
-    b2WorldId GetWorldID() const;
+    // for driving a robot from outside, as an agent does
+    crobots::RobotContext& GetContext(int robot);
+    b2Vec2 GetVelocity(int robot) const;
+    b2Rot GetRotation(int robot) const;
     float GetWidth() const;
+    float GetTimestep() const;
+    uint64_t GetTicks() const;
     void SetDebug(bool debug);
+    void SetDebugBounds(const b2AABB& bounds);
     bool GetDebug() const;
+    void SetProfiling(bool profiling);
+    bool GetProfiling() const;
+    // folds the whole simulation into a rolling hash after every tick, so two runs that ever differ keep differing.
+    // what robot code keeps in its context is left out while recording or replaying commands
+    void SetHashing(bool hashing);
+    bool GetHashing() const;
+    uint64_t GetHash() const;
+    // every value the hash covers, in the order it covers them
+    void GetFields(std::vector<StateField>& fields) const;
+    // captures every robot's commands from the next Reset on. the log must outlive the match
+    void SetRecording(CommandLog* log);
+    // drives robots from the log instead of their own code from the next Reset on, so none are loaded
+    void SetReplay(CommandLog* log);
+    // runs the match as one of world's from the next Init on, which needs the batch physics. the world must
+    // outlive the engine, and it's stepped by TickBatch rather than Tick
+    void SetBatch(BatchWorld* world, int match);
+    // false unless the engine allocates from an arena. counts cover the match since the last Reset
+    bool GetMemory(ArenaStats& stats) const;
+    // bytes the engine holds outside the physics world and robot instances, allocator overhead excluded
+    uint64_t GetFootprint() const;
 
 private:
-    crobots::IRobot* Load(const std::string_view& name, const std::shared_ptr<crobots::RobotContext>& context);
+    // Init short of the first Reset
+    bool Configure(const EngineParams& params);
+    // places the lineup and loads its robots, unless replaying. Reset adds the match bookkeeping
+    bool CreateRobots(uint64_t seed, const std::vector<std::string>& lineup);
+    // the world and the walls around the arena
+    bool CreateWorld();
+    // fills every robot's sightings for the coming updates
+    void Sight();
+    // drives the robots and asks for the physics step
+    void Step();
+    // what the step did to the robots
+    void Collide();
+    void CreateProjectile(const b2Transform& transform, const b2Vec2& velocity);
+    void DestroyProjectiles();
+    uint8_t GetRobot(int body) const;
+    // calls visitor(name, index, element, value) for every value that makes up the simulation. name is a format
+    // taking index, then element for values inside a robot's lists
+    template<typename T>
+    void Visit(T&& visitor) const;
+    void Emit(EventType type, uint8_t robot, uint8_t other, const b2Vec2& position, float value) const;
 
+    // first so it outlives the robot contexts it holds
+    std::unique_ptr<Arena> Memory;
     std::vector<Robot> Robots;
     std::vector<Projectile> Projectiles;
-    std::vector<SDL_SharedObject*> SharedObjects;
-    b2WorldId WorldID;
-    b2BodyId ChainBodyID;
+    std::unique_ptr<IPhysics> Physics;
+    PhysicsType Type;
+    uint64_t Ticks;
+    b2AABB DebugBounds;
+    bool UseDebugBounds;
     bool Debug;
+    bool Profiling;
+    bool Hashing;
+    uint64_t Hash;
+    CommandLog* Recording;
+    CommandLog* Replay;
+    // a forked replay's own copy of the log
+    std::shared_ptr<CommandLog> ReplayCopy;
+    uint64_t TickTime;
+    uint64_t TickStart;
+    // whether physics ran this tick
+    bool Stepped;
+    BatchWorld* Batch;
+    int BatchMatch;
     float Timestep;
-};
\ No newline at end of file
+    float Duration;
+    int SubSteps;
+    bool Settle;
+    std::vector<int> Teams;
+    std::shared_ptr<const Map> Layout;
+    // pairs the grid couldn't clear, kept so sighting doesn't allocate every tick
+    std::vector<std::pair<int, int>> Blocked;
+    // wall segments near the blocked pairs, gathered once per tick
+    std::vector<b2Segment> Walls;
+    // identifies the match in the event log
+    uint32_t Match;
+    bool Ended;
+};
+
+// ticks every engine in lockstep that isn't over yet, so world steps all their matches at once
+void TickBatch(BatchWorld& world, Engine* engines, int count);
\ No newline at end of file
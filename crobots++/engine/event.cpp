@@ -0,0 +1,182 @@
+#include <SDL3/SDL.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "event.hpp"
+#include "queue.hpp"
+
+static constexpr char kMagic[8] = {'C', 'R', 'B', 'E', 'V', 'T', 0, 0};
+static constexpr uint32_t kVersion = 1;
+static constexpr uint32_t kRingSize = 16384;
+static constexpr int kBatchSize = 4096;
+static constexpr uint64_t kIdleDelay = 1000000;
+
+using Ring = SPSCQueue<Event, kRingSize>;
+
+static std::mutex gMutex;
+static std::vector<std::unique_ptr<Ring>> gRings;
+// zero while closed. bumped on every open so threads know to register a ring again
+static std::atomic<uint64_t> gGeneration;
+static uint64_t gGenerations;
+static std::atomic<uint64_t> gDropped;
+static std::atomic<bool> gRunning;
+static std::ofstream gFile;
+static SDL_Thread* gThread;
+
+static bool Flush(std::vector<Ring*>& rings, std::vector<Event>& batch)
+{
+    {
+        std::lock_guard lock{gMutex};
+        rings.clear();
+        for (const std::unique_ptr<Ring>& ring : gRings)
+        {
+            rings.push_back(ring.get());
+        }
+    }
+    bool written = false;
+    for (Ring* ring : rings)
+    {
+        Event event;
+        while (ring->Pop(event))
+        {
+            batch.push_back(event);
+            if (batch.size() == kBatchSize)
+            {
+                gFile.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(Event));
+                batch.clear();
+            }
+            written = true;
+        }
+    }
+    if (!batch.empty())
+    {
+        gFile.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(Event));
+        batch.clear();
+    }
+    return written;
+}
+
+static int Drain(void* data)
+{
+    std::vector<Ring*> rings;
+    std::vector<Event> batch;
+    batch.reserve(kBatchSize);
+    while (gRunning.load(std::memory_order_relaxed))
+    {
+        if (!Flush(rings, batch))
+        {
+            SDL_DelayNS(kIdleDelay);
+        }
+    }
+    // producers are done by now, so one last pass gets everything
+    Flush(rings, batch);
+    return 0;
+}
+
+bool EventLog::Open(const std::filesystem::path& path)
+{
+    Close();
+    gFile.open(path, std::ios::binary | std::ios::trunc);
+    if (gFile.fail())
+    {
+        SDL_Log("Failed to open event log: %s", path.string().data());
+        return false;
+    }
+    uint32_t size = sizeof(Event);
+    gFile.write(kMagic, sizeof(kMagic));
+    gFile.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+    gFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    gDropped.store(0, std::memory_order_relaxed);
+    gRunning.store(true, std::memory_order_relaxed);
+    gThread = SDL_CreateThread(Drain, "events", nullptr);
+    if (!gThread)
+    {
+        SDL_Log("Failed to create event thread: %s", SDL_GetError());
+        gFile.close();
+        return false;
+    }
+    gGeneration.store(++gGenerations, std::memory_order_release);
+    return true;
+}
+
+void EventLog::Close()
+{
+    if (!gThread)
+    {
+        return;
+    }
+    gGeneration.store(0, std::memory_order_release);
+    gRunning.store(false, std::memory_order_relaxed);
+    SDL_WaitThread(gThread, nullptr);
+    gThread = nullptr;
+    gFile.close();
+    {
+        std::lock_guard lock{gMutex};
+        gRings.clear();
+    }
+    uint64_t dropped = gDropped.load(std::memory_order_relaxed);
+    if (dropped)
+    {
+        SDL_Log("Dropped %llu events", (unsigned long long) dropped);
+    }
+}
+
+void EventLog::Write(const Event& event)
+{
+    thread_local Ring* tRing = nullptr;
+    thread_local uint64_t tGeneration = 0;
+    uint64_t generation = gGeneration.load(std::memory_order_acquire);
+    if (!generation)
+    {
+        return;
+    }
+    // only the first event a thread writes after opening takes the lock
+    if (tGeneration != generation)
+    {
+        std::lock_guard lock{gMutex};
+        tRing = gRings.emplace_back(std::make_unique<Ring>()).get();
+        tGeneration = generation;
+    }
+    if (!tRing->Push(event))
+    {
+        gDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool EventLog::IsOpen()
+{
+    return gGeneration.load(std::memory_order_relaxed);
+}
+
+uint64_t EventLog::GetDropped()
+{
+    return gDropped.load(std::memory_order_relaxed);
+}
+
+const char* EventLog::GetName(EventType type)
+{
+    switch (type)
+    {
+    case EventType::MatchStart:
+        return "match_start";
+    case EventType::MatchEnd:
+        return "match_end";
+    case EventType::Collision:
+        return "collision";
+    case EventType::Damage:
+        return "damage";
+    case EventType::Shot:
+        return "shot";
+    case EventType::Scan:
+        return "scan";
+    case EventType::Kill:
+        return "kill";
+    }
+    return "unknown";
+}
\ No newline at end of file
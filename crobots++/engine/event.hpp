@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+enum class EventType : uint8_t
+{
+    MatchStart,
+    MatchEnd,
+    Collision,
+    Damage,
+    Shot,
+    Scan,
+    Kill,
+};
+
+// robot index for events that don't involve one, e.g. a collision with the wall
+static constexpr uint8_t kNoRobot = 0xFF;
+
+struct Event
+{
+    uint64_t Tick;
+    // unique per match within a process
+    uint32_t Match;
+    EventType Type;
+    uint8_t Robot;
+    uint8_t Other;
+    uint8_t Reserved;
+    float X;
+    float Y;
+    // meaning depends on the type, e.g. approach speed for collisions
+    float Value;
+    float Angle;
+};
+
+static_assert(sizeof(Event) == 32, "Events are written to disk as is");
+
+// process wide binary event stream. each producing thread appends to its own ring and a background
+// thread drains them all to disk in batches, so writing an event never locks, allocates or formats
+class EventLog
+{
+public:
+    static bool Open(const std::filesystem::path& path);
+    // every producer must be done writing before closing
+    static void Close();
+    // drops the event if the calling thread's ring is full
+    static void Write(const Event& event);
+    static bool IsOpen();
+    static uint64_t GetDropped();
+    static const char* GetName(EventType type);
+};
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "frustum.hpp"
+#include "simd.hpp"
+
+Frustum::Frustum()
+    : PlaneX{}
+    , PlaneY{}
+    , PlaneZ{}
+    , PlaneW{}
+    , Corners{}
+{
+}
+
+void Frustum::Update(const glm::mat4& viewProj)
+{
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    }
+    // clip space depth is zero to one (see camera.cpp)
+    const glm::vec4 kPlanes[6] =
+    {
+        rows[3] + rows[0],
+        rows[3] - rows[0],
+        rows[3] + rows[1],
+        rows[3] - rows[1],
+        rows[2],
+        rows[3] - rows[2],
+    };
+    for (int i = 0; i < 6; i++)
+    {
+        PlaneX[i] = kPlanes[i].x;
+        PlaneY[i] = kPlanes[i].y;
+        PlaneZ[i] = kPlanes[i].z;
+        PlaneW[i] = kPlanes[i].w;
+    }
+    glm::mat4 inverse = glm::inverse(viewProj);
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec4 corner = inverse * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+        Corners[i].x = corner.x / corner.w;
+        Corners[i].y = corner.y / corner.w;
+        Corners[i].z = corner.z / corner.w;
+    }
+}
+
+void Frustum::Cull(const glm::vec3* centers, const glm::vec3& extents, int count, uint8_t* visible) const
+{
+    float radii[6];
+    for (int i = 0; i < 6; i++)
+    {
+        radii[i] = std::abs(PlaneX[i]) * extents.x + std::abs(PlaneY[i]) * extents.y + std::abs(PlaneZ[i]) * extents.z;
+    }
+    int i = 0;
+    for (; i + kLanes <= count; i += kLanes)
+    {
+        float xs[kLanes];
+        float ys[kLanes];
+        float zs[kLanes];
+        for (int j = 0; j < kLanes; j++)
+        {
+            xs[j] = centers[i + j].x;
+            ys[j] = centers[i + j].y;
+            zs[j] = centers[i + j].z;
+        }
+        Float4 x = Load(xs);
+        Float4 y = Load(ys);
+        Float4 z = Load(zs);
+        // a box is outside once it's behind any one plane
+        Float4 nearest = Set(std::numeric_limits<float>::max());
+        for (int j = 0; j < 6; j++)
+        {
+            Float4 distance = Set(PlaneW[j] + radii[j]);
+            distance = Add(distance, Mul(x, Set(PlaneX[j])));
+            distance = Add(distance, Mul(y, Set(PlaneY[j])));
+            distance = Add(distance, Mul(z, Set(PlaneZ[j])));
+            nearest = Min(nearest, distance);
+        }
+        int bits = GetBits(Less(nearest, Set(0.0f)));
+        for (int j = 0; j < kLanes; j++)
+        {
+            visible[i + j] = !((bits >> j) & 1);
+        }
+    }
+    for (; i < count; i++)
+    {
+        visible[i] = Contains(centers[i], extents);
+    }
+}
+
+bool Frustum::Contains(const glm::vec3& center, const glm::vec3& extents) const
+{
+    for (int i = 0; i < 6; i++)
+    {
+        float radius = std::abs(PlaneX[i]) * extents.x + std::abs(PlaneY[i]) * extents.y + std::abs(PlaneZ[i]) * extents.z;
+        float distance = PlaneX[i] * center.x + PlaneY[i] * center.y + PlaneZ[i] * center.z + PlaneW[i];
+        if (distance + radius < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::GetBounds(float height, glm::vec2& min, glm::vec2& max) const
+{
+    min = glm::vec2(std::numeric_limits<float>::max());
+    max = glm::vec2(std::numeric_limits<float>::lowest());
+    bool found = false;
+    auto add = [&](const glm::vec3& point)
+    {
+        min.x = std::min(min.x, point.x);
+        min.y = std::min(min.y, point.z);
+        max.x = std::max(max.x, point.x);
+        max.y = std::max(max.y, point.z);
+        found = true;
+    };
+    // corners are indexed by their x, y and z bits so edges connect corners one bit apart
+    for (int i = 0; i < 8; i++)
+    {
+        for (int bit = 1; bit < 8; bit <<= 1)
+        {
+            if (i & bit)
+            {
+                continue;
+            }
+            const glm::vec3& a = Corners[i];
+            const glm::vec3& b = Corners[i | bit];
+            float da = a.y - height;
+            float db = b.y - height;
+            if ((da > 0.0f && db > 0.0f) || (da < 0.0f && db < 0.0f))
+            {
+                continue;
+            }
+            if (da == db)
+            {
+                add(a);
+                add(b);
+                continue;
+            }
+            add(a + (b - a) * (da / (da - db)));
+        }
+    }
+    return found;
+}
\ No newline at end of file
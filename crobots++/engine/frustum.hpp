@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+class Frustum
+{
+public:
+    Frustum();
+    void Update(const glm::mat4& viewProj);
+    void Cull(const glm::vec3* centers, const glm::vec3& extents, int count, uint8_t* visible) const;
+    bool Contains(const glm::vec3& center, const glm::vec3& extents) const;
+    bool GetBounds(float height, glm::vec2& min, glm::vec2& max) const;
+
+private:
+    // structure of arrays so four boxes can be tested against a plane at once
+    alignas(16) float PlaneX[6];
+    alignas(16) float PlaneY[6];
+    alignas(16) float PlaneZ[6];
+    alignas(16) float PlaneW[6];
+    glm::vec3 Corners[8];
+};
\ No newline at end of file
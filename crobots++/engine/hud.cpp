@@ -0,0 +1,239 @@
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "hud.hpp"
+#include "state.hpp"
+
+static constexpr float kScale = 2.0f;
+static constexpr float kGlyphWidth = 3.0f;
+static constexpr float kGlyphHeight = 5.0f;
+static constexpr float kAdvance = (kGlyphWidth + 1.0f) * kScale;
+static constexpr float kLineHeight = (kGlyphHeight + 2.0f) * kScale;
+static constexpr float kMargin = 8.0f;
+static constexpr float kPadding = 6.0f;
+static constexpr float kPanelWidth = 300.0f;
+static constexpr float kGraphHeight = 48.0f;
+static constexpr float kNsPerMs = 1000000.0f;
+static constexpr float kFrameTarget = 1000.0f / 60.0f;
+// ticks share the frame with everything else, so anything past this starts to show
+static constexpr float kTickTarget = 1.0f;
+static constexpr uint32_t kBackground = 0x101418;
+static constexpr uint32_t kText = 0xE0E0E0;
+static constexpr uint32_t kHeading = 0x80C0FF;
+static constexpr uint32_t kGood = 0x40C040;
+static constexpr uint32_t kSlow = 0xE0C040;
+static constexpr uint32_t kBad = 0xE04040;
+
+struct Glyph
+{
+    char Character;
+    // five rows of three pixels, top to bottom
+    const char* Pixels;
+};
+
+static constexpr Glyph kGlyphs[] =
+{
+    {'0', "111101101101111"}, {'1', "010110010010111"}, {'2', "111001111100111"}, {'3', "111001111001111"},
+    {'4', "101101111001001"}, {'5', "111100111001111"}, {'6', "111100111101111"}, {'7', "111001001001001"},
+    {'8', "111101111101111"}, {'9', "111101111001111"}, {'A', "010101111101101"}, {'B', "110101110101110"},
+    {'C', "011100100100011"}, {'D', "110101101101110"}, {'E', "111100110100111"}, {'F', "111100110100100"},
+    {'G', "011100101101011"}, {'H', "101101111101101"}, {'I', "111010010010111"}, {'J', "001001001101010"},
+    {'K', "101101110101101"}, {'L', "100100100100111"}, {'M', "101111111101101"}, {'N', "110101101101101"},
+    {'O', "010101101101010"}, {'P', "110101110100100"}, {'Q', "010101101110011"}, {'R', "110101110101101"},
+    {'S', "011100010001110"}, {'T', "111010010010010"}, {'U', "101101101101111"}, {'V', "101101101101010"},
+    {'W', "101101111111101"}, {'X', "101101010101101"}, {'Y', "101101010010010"}, {'Z', "111001010100111"},
+    {'.', "000000000000010"}, {':', "000010000010000"}, {'-', "000000111000000"}, {'/', "001001010100100"},
+    {'%', "101001010100101"}, {'(', "010100100100010"}, {')', "010001001001010"}, {'=', "000111000111000"},
+    {'_', "000000000000111"},
+};
+
+static const char* GetPixels(char character)
+{
+    character = std::toupper(static_cast<unsigned char>(character));
+    for (const Glyph& glyph : kGlyphs)
+    {
+        if (glyph.Character == character)
+        {
+            return glyph.Pixels;
+        }
+    }
+    return nullptr;
+}
+
+static uint32_t GetColor(float time, float target)
+{
+    if (time <= target)
+    {
+        return kGood;
+    }
+    if (time <= target * 2.0f)
+    {
+        return kSlow;
+    }
+    return kBad;
+}
+
+FrameProfile::FrameProfile()
+    : Frame{0}
+    , Wait{0}
+    , Acquire{0}
+    , Build{0}
+    , Upload{0}
+    , Render{0}
+    , Passes{0}
+    , Draws{0}
+    , Uploaded{0}
+    , InstanceCapacity{0}
+    , LineCapacity{0}
+    , SolidPolygonCapacity{0}
+    , HudCapacity{0}
+{
+}
+
+Hud::Hud()
+    : Vertices{}
+    , FrameTimes{}
+    , TickTimes{}
+    , FrameSample{0}
+    , TickSample{0}
+    , Ticks{0}
+{
+}
+
+void Hud::Build(const FrameProfile& frame, const State& state, int width, int height)
+{
+    Vertices.clear();
+    FrameTimes[FrameSample] = frame.Frame / kNsPerMs;
+    FrameSample = (FrameSample + 1) % kSamples;
+    // only sample ticks that actually happened so a paused match doesn't flatten the graph
+    if (state.Profiling && state.Ticks != Ticks)
+    {
+        TickTimes[TickSample] = state.Profile.Time / kNsPerMs;
+        TickSample = (TickSample + 1) % kSamples;
+        Ticks = state.Ticks;
+    }
+    int lines = 15 + (state.Profiling ? 5 + state.Profile.Updates.size() : 1);
+    float panelHeight = kPadding * 2.0f + lines * kLineHeight + (kGraphHeight + kLineHeight) * 2.0f;
+    DrawRect(kMargin, kMargin, kPanelWidth, std::min(panelHeight, height - kMargin * 2.0f), kBackground);
+    float x = kMargin + kPadding;
+    float y = kMargin + kPadding;
+    auto line = [&]()
+    {
+        float current = y;
+        y += kLineHeight;
+        return current;
+    };
+    DrawGraph(x, y, FrameTimes, FrameSample, kFrameTarget, "frame");
+    y += kGraphHeight + kLineHeight;
+    DrawGraph(x, y, TickTimes, TickSample, kTickTarget, "tick");
+    y += kGraphHeight + kLineHeight;
+    DrawText(x, line(), kHeading, "renderer %dx%d", width, height);
+    DrawText(x, line(), kText, "frame   %6.2f ms", frame.Frame / kNsPerMs);
+    DrawText(x, line(), kText, "wait    %6.2f ms", frame.Wait / kNsPerMs);
+    DrawText(x, line(), kText, "acquire %6.2f ms", frame.Acquire / kNsPerMs);
+    DrawText(x, line(), kText, "build   %6.2f ms", frame.Build / kNsPerMs);
+    DrawText(x, line(), kText, "upload  %6.2f ms", frame.Upload / kNsPerMs);
+    DrawText(x, line(), kText, "render  %6.2f ms", frame.Render / kNsPerMs);
+    DrawText(x, line(), kText, "passes %d draws %d", frame.Passes, frame.Draws);
+    DrawText(x, line(), kText, "uploaded %8.1f kb", frame.Uploaded / 1024.0f);
+    DrawText(x, line(), kText, "instances %8.1f kb", frame.InstanceCapacity / 1024.0f);
+    DrawText(x, line(), kText, "lines     %8.1f kb", frame.LineCapacity / 1024.0f);
+    DrawText(x, line(), kText, "polygons  %8.1f kb", frame.SolidPolygonCapacity / 1024.0f);
+    DrawText(x, line(), kText, "hud       %8.1f kb", frame.HudCapacity / 1024.0f);
+    line();
+    DrawText(x, line(), kHeading, "engine tick %llu", (unsigned long long) state.Ticks);
+    if (!state.Profiling)
+    {
+        DrawText(x, line(), kText, "waiting for profile");
+        return;
+    }
+    const TickProfile& profile = state.Profile;
+    DrawText(x, line(), kText, "tick    %6.3f ms", profile.Time / kNsPerMs);
+    DrawText(x, line(), kText, "step    %6.3f ms", profile.Physics.step);
+    DrawText(x, line(), kText, "collide %6.3f ms solve %6.3f ms", profile.Physics.collide, profile.Physics.solve);
+    DrawText(x, line(), kText, "bodies %d contacts %d islands %d", profile.Counters.bodyCount, profile.Counters.contactCount, profile.Counters.islandCount);
+    DrawText(x, line(), kText, "box2d %.1f kb tasks %d", profile.Counters.byteCount / 1024.0f, profile.Counters.taskCount);
+    for (int i = 0; i < profile.Updates.size(); i++)
+    {
+        DrawText(x, line(), kText, "robot %d %8.3f us", i, profile.Updates[i] / 1000.0f);
+    }
+}
+
+const std::vector<HudVertex>& Hud::GetVertices() const
+{
+    return Vertices;
+}
+
+void Hud::DrawRect(float x, float y, float width, float height, uint32_t color)
+{
+    const glm::vec3 kCorners[6] =
+    {
+        {x, y, 0.0f},
+        {x, y + height, 0.0f},
+        {x + width, y + height, 0.0f},
+        {x, y, 0.0f},
+        {x + width, y + height, 0.0f},
+        {x + width, y, 0.0f},
+    };
+    for (const glm::vec3& corner : kCorners)
+    {
+        Vertices.emplace_back(corner, color);
+    }
+}
+
+void Hud::DrawText(float x, float y, uint32_t color, const char* format, ...)
+{
+    char text[128];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    for (const char* character = text; *character; character++, x += kAdvance)
+    {
+        const char* pixels = GetPixels(*character);
+        if (!pixels)
+        {
+            continue;
+        }
+        // one quad per horizontal run rather than per pixel
+        for (int row = 0; row < kGlyphHeight; row++)
+        {
+            for (int column = 0; column < kGlyphWidth; column++)
+            {
+                if (pixels[row * 3 + column] != '1')
+                {
+                    continue;
+                }
+                int start = column;
+                while (column + 1 < kGlyphWidth && pixels[row * 3 + column + 1] == '1')
+                {
+                    column++;
+                }
+                DrawRect(x + start * kScale, y + row * kScale, (column - start + 1) * kScale, kScale, color);
+            }
+        }
+    }
+}
+
+void Hud::DrawGraph(float x, float y, const float* samples, int first, float target, const char* label)
+{
+    float peak = *std::max_element(samples, samples + kSamples);
+    float scale = std::max(peak, target * 2.0f);
+    float width = (kPanelWidth - kPadding * 2.0f) / kSamples;
+    // oldest sample on the left
+    for (int i = 0; i < kSamples; i++)
+    {
+        float sample = samples[(first + i) % kSamples];
+        float height = std::max(sample / scale * kGraphHeight, 1.0f);
+        DrawRect(x + i * width, y + kGraphHeight - height, width, height, GetColor(sample, target));
+    }
+    // marks the target so bars above it stand out
+    DrawRect(x, y + kGraphHeight - target / scale * kGraphHeight, kPanelWidth - kPadding * 2.0f, 1.0f, kText);
+    DrawText(x, y + kGraphHeight + 2.0f, kText, "%s max %.2f ms", label, peak);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct State;
+
+// renderer side counterpart to TickProfile. times are in nanoseconds
+struct FrameProfile
+{
+    FrameProfile();
+
+    uint64_t Frame;
+    uint64_t Wait;
+    uint64_t Acquire;
+    uint64_t Build;
+    uint64_t Upload;
+    uint64_t Render;
+    int Passes;
+    int Draws;
+    uint64_t Uploaded;
+    uint64_t InstanceCapacity;
+    uint64_t LineCapacity;
+    uint64_t SolidPolygonCapacity;
+    uint64_t HudCapacity;
+};
+
+struct HudVertex
+{
+    glm::vec3 Position;
+    uint32_t Color;
+};
+
+// builds the performance overlay as screen space triangles so it fits in a single draw
+class Hud
+{
+public:
+    static constexpr int kSamples = 128;
+
+    Hud();
+    void Build(const FrameProfile& frame, const State& state, int width, int height);
+    const std::vector<HudVertex>& GetVertices() const;
+
+private:
+    void DrawRect(float x, float y, float width, float height, uint32_t color);
+    void DrawText(float x, float y, uint32_t color, const char* format, ...);
+    void DrawGraph(float x, float y, const float* samples, int first, float target, const char* label);
+
+    std::vector<HudVertex> Vertices;
+    // milliseconds, written round robin
+    float FrameTimes[kSamples];
+    float TickTimes[kSamples];
+    int FrameSample;
+    int TickSample;
+    uint64_t Ticks;
+};
\ No newline at end of file
@@ -2,54 +2,396 @@
 #include <SDL3/SDL_main.h>
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "buffer.hpp"
 #include "camera.hpp"
+#include "commands.hpp"
 #include "engine.hpp"
+#include "map.hpp"
+#include "module.hpp"
+#include "queue.hpp"
 #include "renderer.hpp"
+#ifdef CROBOTS_SPECTATOR
+#include "spectator.hpp"
+#endif
+#include "state.hpp"
+#include "triple_buffer.hpp"
+#include "wall.hpp"
 
-static EngineParams GetParams(int argc, char** argv)
+static constexpr uint64_t kMaxTicksPerUpdate = 8;
+static constexpr float kDebugBoundsMargin = 1.0f;
+static constexpr int kSpectateTimeout = 10;
+// box2d allows 128 worlds and the tiles get too small to read well before that
+static constexpr int kMaxWall = 64;
+// longest the window sleeps between frames with nothing to draw. new states wake it sooner
+static constexpr int kIdleTimeout = 250;
+
+enum class Command
+{
+    Pause,
+    Debug,
+    Profile,
+};
+
+struct Params
+{
+    Params()
+        : Engine{}
+        , Broadcast{}
+        , Spectate{}
+        , Cull{false}
+        , Wall{0}
+        , Record{}
+    {
+    }
+
+    EngineParams Engine;
+    // address to stream every tick to spectators on
+    std::string Broadcast;
+    // address of a host to watch instead of simulating locally
+    std::string Spectate;
+    // only ask the host for what the camera can see
+    bool Cull;
+    // matches played side by side in a grid, 0 for just the one
+    int Wall;
+    // where to save every robot's commands on exit, for replaying without them
+    std::filesystem::path Record;
+};
+
+struct Simulation
+{
+    Simulation()
+        : Matches{}
+        , Tiles{}
+        , Layout{}
+        , Lineup{}
+        , Seed{0}
+        , States{}
+        , DebugBounds{}
+        , Commands{}
+        , Running{true}
+        , WakeEvent{0}
+        , Waking{false}
+#ifdef CROBOTS_SPECTATOR
+        , Server{}
+        , Client{}
+        , Broadcasting{false}
+        , Culling{false}
+#endif
+    {
+    }
+
+    // sized once up front, engines aren't moved once initialized
+    std::vector<Engine> Matches;
+    // only used by the wall, each match's state before it's merged
+    std::vector<State> Tiles;
+    Wall Layout;
+    std::vector<std::string> Lineup;
+    // for the next match the wall starts once one finishes
+    uint64_t Seed;
+    TripleBuffer<State> States;
+    TripleBuffer<b2AABB> DebugBounds;
+    SPSCQueue<Command, 64> Commands;
+    std::atomic<bool> Running;
+    // pushed when a state is published so an idle window wakes for it
+    uint32_t WakeEvent;
+    // set while a wake event is queued so only one is
+    std::atomic<bool> Waking;
+#ifdef CROBOTS_SPECTATOR
+    SpectatorServer Server;
+    SpectatorClient Client;
+    bool Broadcasting;
+    bool Culling;
+#endif
+};
+
+static bool GetParams(int argc, char** argv, Params& params)
 {
-    EngineParams params;
     for (int i = 1; i < argc; i++)
     {
         std::string outer = argv[i];
         if (outer == "--robots")
         {
-            for (i++; i < argc; i++)
+            for (; i + 1 < argc; i++)
+            {
+                std::string inner = argv[i + 1];
+                if (inner.starts_with("--"))
+                {
+                    break;
+                }
+                params.Engine.Robots.push_back(inner);
+            }
+        }
+        else if (outer == "--map" && i + 1 < argc)
+        {
+            std::shared_ptr<Map> map = std::make_shared<Map>();
+            if (!map->Load(argv[++i]))
+            {
+                return false;
+            }
+            params.Engine.Layout = map;
+        }
+        else if (outer == "--teams")
+        {
+            for (; i + 1 < argc; i++)
             {
-                std::string inner = argv[i];
+                std::string inner = argv[i + 1];
                 if (inner.starts_with("--"))
                 {
                     break;
                 }
-                params.Robots.push_back(inner);
+                try
+                {
+                    params.Engine.Teams.push_back(std::stoi(inner));
+                }
+                catch (const std::exception& e)
+                {
+                    SDL_Log("Failed to parse team: %s", e.what());
+                    return false;
+                }
             }
         }
-        else if (outer == "--timestep")
+        else if (outer == "--timestep" && i + 1 < argc)
         {
-            std::string inner = argv[i];
+            std::string inner = argv[++i];
             try
             {
-                params.Timestep = std::stof(inner);
+                params.Engine.Timestep = std::stof(inner);
             }
-            catch (const std::invalid_argument& e)
+            catch (const std::exception& e)
             {
                 SDL_Log("Failed to parse timestep: %s", e.what());
-                return params;
+                return false;
             }
         }
+        else if (outer == "--seed" && i + 1 < argc)
+        {
+            std::string inner = argv[++i];
+            try
+            {
+                params.Engine.Seed = std::stoull(inner);
+            }
+            catch (const std::exception& e)
+            {
+                SDL_Log("Failed to parse seed: %s", e.what());
+                return false;
+            }
+        }
+        else if (outer == "--broadcast" && i + 1 < argc)
+        {
+            params.Broadcast = argv[++i];
+        }
+        else if (outer == "--spectate" && i + 1 < argc)
+        {
+            params.Spectate = argv[++i];
+        }
+        else if (outer == "--cull")
+        {
+            params.Cull = true;
+        }
+        else if (outer == "--record" && i + 1 < argc)
+        {
+            params.Record = argv[++i];
+        }
+        else if (outer == "--wall" && i + 1 < argc)
+        {
+            std::string inner = argv[++i];
+            try
+            {
+                params.Wall = std::stoi(inner);
+            }
+            catch (const std::exception& e)
+            {
+                SDL_Log("Failed to parse wall: %s", e.what());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void Wake(Simulation* simulation)
+{
+    if (simulation->Waking.exchange(true, std::memory_order_relaxed))
+    {
+        return;
     }
-    return params;
+    SDL_Event event{};
+    event.type = simulation->WakeEvent;
+    SDL_PushEvent(&event);
 }
 
+static void Publish(Simulation* simulation)
+{
+    State& state = simulation->States.GetBack();
+    if (simulation->Matches.size() == 1)
+    {
+        simulation->Matches.front().GetState(state);
+    }
+    else
+    {
+        for (int i = 0; i < simulation->Matches.size(); i++)
+        {
+            simulation->Matches[i].GetState(simulation->Tiles[i]);
+        }
+        simulation->Layout.Build(simulation->Tiles, state);
+    }
+#ifdef CROBOTS_SPECTATOR
+    if (simulation->Broadcasting)
+    {
+        simulation->Server.Publish(state);
+    }
+#endif
+    simulation->States.Publish();
+    Wake(simulation);
+}
+
+// runs on its own thread at the engine timestep, independent of presentation
+static int Simulate(void* data)
+{
+    Simulation* simulation = static_cast<Simulation*>(data);
+    std::vector<Engine>& matches = simulation->Matches;
+    Engine& engine = matches.front();
+    // matches that failed to reset, left on their last state since their robots may be half loaded
+    std::vector<bool> dead(matches.size(), false);
+    uint64_t timestep = std::max<uint64_t>(engine.GetTimestep() * SDL_NS_PER_SECOND, 1);
+    uint64_t accumulator = 0;
+    uint64_t time2 = SDL_GetTicksNS();
+    uint64_t time1 = time2;
+    bool paused = false;
+    Publish(simulation);
+    while (simulation->Running.load(std::memory_order_relaxed))
+    {
+        bool dirty = false;
+        Command command;
+        while (simulation->Commands.Pop(command))
+        {
+            switch (command)
+            {
+            case Command::Pause:
+                paused = !paused;
+                break;
+            case Command::Debug:
+                {
+                    bool debug = !engine.GetDebug();
+                    for (Engine& match : matches)
+                    {
+                        match.SetDebug(debug);
+                    }
+                }
+                dirty = true;
+                break;
+            case Command::Profile:
+                {
+                    bool profiling = !engine.GetProfiling();
+                    for (Engine& match : matches)
+                    {
+                        match.SetProfiling(profiling);
+                    }
+                }
+                dirty = true;
+                break;
+            }
+        }
+        if (simulation->DebugBounds.Update())
+        {
+            // bounds come from the camera, in wall space
+            for (int i = 0; i < matches.size(); i++)
+            {
+                b2AABB bounds = simulation->DebugBounds.GetFront();
+                b2Vec2 offset = simulation->Layout.GetOffset(i);
+                bounds.lowerBound = b2Sub(bounds.lowerBound, offset);
+                bounds.upperBound = b2Sub(bounds.upperBound, offset);
+                matches[i].SetDebugBounds(bounds);
+            }
+            dirty = true;
+        }
+        time2 = SDL_GetTicksNS();
+        accumulator += time2 - time1;
+        time1 = time2;
+        if (paused)
+        {
+            accumulator = 0;
+        }
+        accumulator = std::min(accumulator, timestep * kMaxTicksPerUpdate);
+        while (accumulator >= timestep)
+        {
+            for (int i = 0; i < matches.size(); i++)
+            {
+                Engine& match = matches[i];
+                if (dead[i])
+                {
+                    continue;
+                }
+                // the wall keeps every tile busy, a lone match stays on its final state so the window can idle
+                if (match.IsOver())
+                {
+                    if (matches.size() == 1)
+                    {
+                        continue;
+                    }
+                    if (!match.Reset(simulation->Seed++, simulation->Lineup))
+                    {
+                        SDL_Log("Failed to reset match: %d", i);
+                        dead[i] = true;
+                        continue;
+                    }
+                }
+                match.Tick();
+                dirty = true;
+            }
+            accumulator -= timestep;
+        }
+        if (dirty)
+        {
+            Publish(simulation);
+        }
+        SDL_DelayNS(timestep - accumulator);
+    }
+    return 0;
+}
+
+#ifdef CROBOTS_SPECTATOR
+// stands in for the simulation thread when watching a remote match
+static int Spectate(void* data)
+{
+    Simulation* simulation = static_cast<Simulation*>(data);
+    SpectatorClient& client = simulation->Client;
+    while (simulation->Running.load(std::memory_order_relaxed))
+    {
+        bool updated;
+        if (!client.Update(simulation->States.GetBack(), updated, kSpectateTimeout))
+        {
+            SDL_Log("Lost connection to host");
+            return 1;
+        }
+        if (updated)
+        {
+            simulation->States.Publish();
+            Wake(simulation);
+        }
+        if (simulation->DebugBounds.Update() && simulation->Culling && !client.SetInterest(simulation->DebugBounds.GetFront()))
+        {
+            SDL_Log("Lost connection to host");
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
+
 int main(int argc, char** argv)
 {
     SDL_Window* window;
-    Engine engine;
+    Simulation simulation;
     Renderer renderer;
     Camera camera;
     if (!SDL_Init(SDL_INIT_VIDEO))
@@ -57,11 +399,76 @@ int main(int argc, char** argv)
         SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
         return 1;
     }
-    if (!engine.Init(GetParams(argc, argv)))
+    Params params;
+    if (!GetParams(argc, argv, params))
+    {
+        return 1;
+    }
+#ifdef CROBOTS_SPECTATOR
+    bool spectating = !params.Spectate.empty();
+    if (spectating)
+    {
+        if (!simulation.Client.Connect(params.Spectate))
+        {
+            SDL_Log("Failed to connect to host: %s", params.Spectate.data());
+            return 1;
+        }
+        simulation.Culling = params.Cull;
+    }
+    else if (!params.Broadcast.empty())
+    {
+        if (!simulation.Server.Init(params.Broadcast))
+        {
+            SDL_Log("Failed to initialize spectator server");
+            return 1;
+        }
+        simulation.Broadcasting = true;
+    }
+#else
+    bool spectating = false;
+    if (!params.Spectate.empty() || !params.Broadcast.empty())
+    {
+        SDL_Log("Spectating isn't supported on this platform");
+        return 1;
+    }
+#endif
+    if (params.Wall < 0 || params.Wall > kMaxWall)
     {
-        SDL_Log("Failed to initialize engine");
+        SDL_Log("Wall must have between 0 and %d (inclusive) matches: %d", kMaxWall, params.Wall);
         return 1;
     }
+    if (spectating && params.Wall)
+    {
+        SDL_Log("Walls are only shown for matches played locally");
+        return 1;
+    }
+    if (!params.Record.empty() && (spectating || params.Wall))
+    {
+        SDL_Log("Only a single local match can be recorded");
+        return 1;
+    }
+    simulation.Matches = std::vector<Engine>(std::max(params.Wall, 1));
+    simulation.Tiles.resize(simulation.Matches.size());
+    simulation.Lineup = params.Engine.Robots;
+    simulation.Seed = params.Engine.Seed;
+    simulation.Layout.Init(simulation.Matches.size(), simulation.Matches.front().GetWidth());
+    CommandLog recording;
+    if (!params.Record.empty())
+    {
+        // the hash lets a replay check it reproduced the match exactly
+        simulation.Matches.front().SetRecording(&recording);
+        simulation.Matches.front().SetHashing(true);
+    }
+    for (Engine& engine : simulation.Matches)
+    {
+        EngineParams engineParams = params.Engine;
+        engineParams.Seed = simulation.Seed++;
+        if (!spectating && !engine.Init(engineParams))
+        {
+            SDL_Log("Failed to initialize engine");
+            return 1;
+        }
+    }
     window = SDL_CreateWindow("Crobots++", 960, 540, SDL_WINDOW_RESIZABLE);
     if (!window)
     {
@@ -73,14 +480,45 @@ int main(int argc, char** argv)
         SDL_Log("Failed to initialize renderer");
         return 1;
     }
-    camera.SetCenter(engine.GetWidth() / 2.0f, engine.GetWidth() / 2.0f);
+    camera.SetCenter(simulation.Layout.GetWidth() / 2.0f, simulation.Layout.GetHeight() / 2.0f);
+    simulation.WakeEvent = SDL_RegisterEvents(1);
+    if (!simulation.WakeEvent)
+    {
+        SDL_Log("Failed to register wake event: %s", SDL_GetError());
+        return 1;
+    }
+    SDL_ThreadFunction function = Simulate;
+#ifdef CROBOTS_SPECTATOR
+    if (spectating)
+    {
+        function = Spectate;
+    }
+#endif
+    SDL_Thread* thread = SDL_CreateThread(function, "simulation", &simulation);
+    if (!thread)
+    {
+        SDL_Log("Failed to create simulation thread: %s", SDL_GetError());
+        return 1;
+    }
     bool running = true;
-    uint64_t time2 = SDL_GetTicks();
+    // frames are only drawn when something on them changed, and never while nobody can see them
+    bool visible = !(SDL_GetWindowFlags(window) & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED | SDL_WINDOW_OCCLUDED));
+    bool redraw = true;
+    bool moving = false;
+    bool bounded = false;
+    b2AABB published{};
+    uint64_t time2 = SDL_GetTicksNS();
     uint64_t time1 = time2;
     while (running)
     {
-        time2 = SDL_GetTicks();
-        float deltaTime = time2 - time1;
+        if (!visible || (!redraw && !moving))
+        {
+            SDL_WaitEventTimeout(nullptr, kIdleTimeout);
+            // time spent asleep isn't camera movement
+            time1 = SDL_GetTicksNS();
+        }
+        time2 = SDL_GetTicksNS();
+        float deltaTime = float(time2 - time1) / SDL_NS_PER_MS;
         time1 = time2;
         SDL_Event event;
         while (SDL_PollEvent(&event))
@@ -107,6 +545,35 @@ int main(int argc, char** argv)
                         SDL_SetWindowRelativeMouseMode(window, false);
                     }
                 }
+                else if (event.key.scancode == SDL_SCANCODE_P && !event.key.repeat)
+                {
+                    simulation.Commands.Push(Command::Pause);
+                }
+                else if (event.key.scancode == SDL_SCANCODE_TAB && !event.key.repeat)
+                {
+                    simulation.Commands.Push(Command::Debug);
+                }
+                else if (event.key.scancode == SDL_SCANCODE_F3 && !event.key.repeat)
+                {
+                    // the engine only pays for timing while someone is looking
+                    renderer.SetHud(!renderer.GetHud());
+                    simulation.Commands.Push(Command::Profile);
+                    redraw = true;
+                }
+                break;
+            case SDL_EVENT_WINDOW_HIDDEN:
+            case SDL_EVENT_WINDOW_MINIMIZED:
+            case SDL_EVENT_WINDOW_OCCLUDED:
+                visible = false;
+                break;
+            case SDL_EVENT_WINDOW_SHOWN:
+            case SDL_EVENT_WINDOW_RESTORED:
+            case SDL_EVENT_WINDOW_EXPOSED:
+                visible = true;
+                redraw = true;
+                break;
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                redraw = true;
                 break;
             case SDL_EVENT_WINDOW_FOCUS_LOST:
                 if (SDL_GetWindowRelativeMouseMode(window))
@@ -138,12 +605,60 @@ int main(int argc, char** argv)
         delta.z += keys[SDL_SCANCODE_W];
         delta.z -= keys[SDL_SCANCODE_S];
         camera.Move(delta.x, delta.y, delta.z, deltaTime);
-        engine.Tick();
-        renderer.Draw(engine, camera);
+        moving = delta != glm::vec3{0.0f};
+        // cleared first so a state published after the update still wakes the next wait
+        simulation.Waking.store(false, std::memory_order_relaxed);
+        redraw = simulation.States.Update() || camera.IsDirty() || redraw;
+        if (!visible || !redraw)
+        {
+            continue;
+        }
+        renderer.Draw(simulation.States.GetFront(), camera);
+        redraw = false;
+        glm::vec2 min;
+        glm::vec2 max;
+        b2AABB bounds;
+        if (camera.GetFrustum().GetBounds(0.0f, min, max))
+        {
+            bounds.lowerBound = {min.x - kDebugBoundsMargin, min.y - kDebugBoundsMargin};
+            bounds.upperBound = {max.x + kDebugBoundsMargin, max.y + kDebugBoundsMargin};
+        }
+        else
+        {
+            bounds.lowerBound = {0.0f, 0.0f};
+            bounds.upperBound = {0.0f, 0.0f};
+        }
+        // republishing unchanged bounds would have the simulation publish a state and wake us again
+        if (bounded && bounds.lowerBound.x == published.lowerBound.x && bounds.lowerBound.y == published.lowerBound.y &&
+            bounds.upperBound.x == published.upperBound.x && bounds.upperBound.y == published.upperBound.y)
+        {
+            continue;
+        }
+        simulation.DebugBounds.GetBack() = bounds;
+        simulation.DebugBounds.Publish();
+        published = bounds;
+        bounded = true;
+    }
+    simulation.Running.store(false, std::memory_order_relaxed);
+    SDL_WaitThread(thread, nullptr);
+    if (!params.Record.empty() && !recording.Save(params.Record))
+    {
+        SDL_Log("Failed to save command log");
     }
     renderer.Destroy();
     SDL_DestroyWindow(window);
-    engine.Destroy();
+#ifdef CROBOTS_SPECTATOR
+    simulation.Server.Destroy();
+    simulation.Client.Close();
+#endif
+    if (!spectating)
+    {
+        for (Engine& engine : simulation.Matches)
+        {
+            engine.Destroy();
+        }
+    }
+    ModuleRegistry::Unload();
     SDL_Quit();
     return 0;
 }
\ No newline at end of file
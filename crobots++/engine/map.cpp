@@ -0,0 +1,241 @@
+#include <SDL3/SDL.h>
+#include <box2d/box2d.h>
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include "map.hpp"
+
+static constexpr char kMagic[8] = {'C', 'R', 'B', 'M', 'A', 'P', 0, 0};
+static constexpr uint32_t kVersion = 1;
+static constexpr int kMaxSize = 1024;
+// counterclockwise, so turning left is one step on and right three
+static constexpr int kDirections[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+static constexpr int kTurns[3] = {1, 0, 3};
+
+static constexpr size_t kHeader = sizeof(kMagic) + sizeof(uint32_t) + sizeof(uint16_t);
+
+Map::Map()
+    : Size{1}
+    , Cells(1, 0)
+{
+}
+
+bool Map::Load(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (file.fail())
+    {
+        SDL_Log("Failed to open map: %s", path.string().data());
+        return false;
+    }
+    // the largest map is well under a megabyte, anything past it isn't a map
+    std::vector<uint8_t> data(kHeader + (kMaxSize * kMaxSize + 7) / 8 + 1);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    data.resize(file.gcount());
+    if (!Parse(data))
+    {
+        SDL_Log("Failed to parse map: %s", path.string().data());
+        return false;
+    }
+    return true;
+}
+
+bool Map::Parse(const std::vector<uint8_t>& data)
+{
+    uint32_t version;
+    uint16_t size;
+    if (data.size() < kHeader || std::memcmp(data.data(), kMagic, sizeof(kMagic)))
+    {
+        return false;
+    }
+    std::memcpy(&version, data.data() + sizeof(kMagic), sizeof(version));
+    std::memcpy(&size, data.data() + sizeof(kMagic) + sizeof(version), sizeof(size));
+    if (version != kVersion || size < 1 || size > kMaxSize || data.size() != kHeader + (size * size + 7) / 8)
+    {
+        return false;
+    }
+    Size = size;
+    Cells.resize(size * size);
+    for (int i = 0; i < Cells.size(); i++)
+    {
+        Cells[i] = (data[kHeader + i / 8] >> (i % 8)) & 1;
+    }
+    return true;
+}
+
+void Map::Save(std::vector<uint8_t>& data) const
+{
+    uint32_t version = kVersion;
+    uint16_t size = Size;
+    data.assign(kHeader + (Cells.size() + 7) / 8, 0);
+    std::memcpy(data.data(), kMagic, sizeof(kMagic));
+    std::memcpy(data.data() + sizeof(kMagic), &version, sizeof(version));
+    std::memcpy(data.data() + sizeof(kMagic) + sizeof(version), &size, sizeof(size));
+    for (int i = 0; i < Cells.size(); i++)
+    {
+        data[kHeader + i / 8] |= Cells[i] << (i % 8);
+    }
+}
+
+int Map::GetSize() const
+{
+    return Size;
+}
+
+bool Map::IsSolid(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= Size || y >= Size)
+    {
+        return true;
+    }
+    return Cells[y * Size + x];
+}
+
+bool Map::IsSolid(const b2Vec2& point, float width) const
+{
+    float scale = Size / width;
+    return IsSolid(int(std::floor(point.x * scale)), int(std::floor(point.y * scale)));
+}
+
+void Map::GetOutlines(std::vector<std::vector<b2Vec2>>& outlines, float width) const
+{
+    outlines.clear();
+    // edges between a free cell and a solid one, as a bit per direction on the vertex they start from
+    int stride = Size + 1;
+    std::vector<uint8_t> edges(stride * stride, 0);
+    for (int y = 0; y < Size; y++)
+    {
+        for (int x = 0; x < Size; x++)
+        {
+            if (IsSolid(x, y))
+            {
+                continue;
+            }
+            if (IsSolid(x - 1, y))
+            {
+                edges[y * stride + x] |= 1 << 1;
+            }
+            if (IsSolid(x + 1, y))
+            {
+                edges[(y + 1) * stride + x + 1] |= 1 << 3;
+            }
+            if (IsSolid(x, y - 1))
+            {
+                edges[y * stride + x + 1] |= 1 << 2;
+            }
+            if (IsSolid(x, y + 1))
+            {
+                edges[(y + 1) * stride + x] |= 1 << 0;
+            }
+        }
+    }
+    float scale = width / Size;
+    for (int start = 0; start < edges.size(); start++)
+    {
+        while (edges[start])
+        {
+            int first = std::countr_zero(edges[start]);
+            edges[start] &= ~(1 << first);
+            std::vector<b2Vec2>& outline = outlines.emplace_back();
+            int vertex = start;
+            int direction = first;
+            while (true)
+            {
+                vertex += kDirections[direction][1] * stride + kDirections[direction][0];
+                // turning left first keeps walls that only touch at a corner on separate loops
+                int next = -1;
+                bool closed = false;
+                for (int turn : kTurns)
+                {
+                    int candidate = (direction + turn) % 4;
+                    if (vertex == start && candidate == first)
+                    {
+                        next = candidate;
+                        closed = true;
+                        break;
+                    }
+                    if (edges[vertex] & (1 << candidate))
+                    {
+                        next = candidate;
+                        break;
+                    }
+                }
+                if (next != direction)
+                {
+                    outline.push_back({float(vertex % stride) * scale, float(vertex / stride) * scale});
+                }
+                if (closed || next == -1)
+                {
+                    break;
+                }
+                edges[vertex] &= ~(1 << next);
+                direction = next;
+            }
+        }
+    }
+}
+
+bool Map::IsClear(const b2Vec2& a, const b2Vec2& b, float width) const
+{
+    // walks every cell the segment passes through, after Amanatides and Woo
+    float scale = Size / width;
+    float x0 = a.x * scale;
+    float y0 = a.y * scale;
+    float dx = b.x * scale - x0;
+    float dy = b.y * scale - y0;
+    int x = int(std::floor(x0));
+    int y = int(std::floor(y0));
+    int steps = std::abs(int(std::floor(x0 + dx)) - x) + std::abs(int(std::floor(y0 + dy)) - y);
+    int stepX = dx > 0.0f ? 1 : -1;
+    int stepY = dy > 0.0f ? 1 : -1;
+    constexpr float kInfinity = std::numeric_limits<float>::infinity();
+    float deltaX = dx != 0.0f ? std::abs(1.0f / dx) : kInfinity;
+    float deltaY = dy != 0.0f ? std::abs(1.0f / dy) : kInfinity;
+    float nextX = dx != 0.0f ? (dx > 0.0f ? x + 1 - x0 : x0 - x) * deltaX : kInfinity;
+    float nextY = dy != 0.0f ? (dy > 0.0f ? y + 1 - y0 : y0 - y) * deltaY : kInfinity;
+    if (IsSolid(x, y))
+    {
+        return false;
+    }
+    while (steps > 0)
+    {
+        if (nextX < nextY)
+        {
+            x += stepX;
+            nextX += deltaX;
+            steps--;
+        }
+        else if (nextY < nextX)
+        {
+            y += stepY;
+            nextY += deltaY;
+            steps--;
+        }
+        else
+        {
+            // straight through a corner, so either neighbour could block it
+            if (IsSolid(x + stepX, y) || IsSolid(x, y + stepY))
+            {
+                return false;
+            }
+            x += stepX;
+            y += stepY;
+            nextX += deltaX;
+            nextY += deltaY;
+            steps -= 2;
+        }
+        if (IsSolid(x, y))
+        {
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <box2d/box2d.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// walls and cover on a square grid stretched over the arena. on disk it's "CRBMAP" and two zero bytes, a
+// uint32 version, a uint16 cells per side and then one bit per cell, row by row from the bottom left. set
+// bits are solid
+class Map
+{
+public:
+    // a single free cell, i.e. the empty arena
+    Map();
+    bool Load(const std::filesystem::path& path);
+    // the same format as on disk, for maps that travel with a shard
+    bool Parse(const std::vector<uint8_t>& data);
+    void Save(std::vector<uint8_t>& data) const;
+    bool operator==(const Map& other) const = default;
+    int GetSize() const;
+    // anything off the grid counts as solid
+    bool IsSolid(int x, int y) const;
+    bool IsSolid(const b2Vec2& point, float width) const;
+    // outlines of the free space scaled to an arena width across, wound so free space is on the right the
+    // way box2d's one sided chains want it. each outline is one loop with collinear edges merged, so a map
+    // costs one chain per wall outline rather than one per cell
+    void GetOutlines(std::vector<std::vector<b2Vec2>>& outlines, float width) const;
+    // true if the segment only crosses free cells. conservative, a segment that grazes a solid cell
+    // counts as blocked and needs an exact test
+    bool IsClear(const b2Vec2& a, const b2Vec2& b, float width) const;
+
+private:
+    int Size;
+    // row major from the bottom left, 1 for solid
+    std::vector<uint8_t> Cells;
+};
\ No newline at end of file
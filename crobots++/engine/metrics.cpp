@@ -0,0 +1,257 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "metrics.hpp"
+
+static constexpr int kCounters = int(MetricCounter::Count);
+static constexpr int kGauges = int(MetricGauge::Count);
+static constexpr int kRobots = 256;
+// upper bounds double from 1us, the last bucket is everything slower
+static constexpr int kBuckets = 16;
+
+struct MetricInfo
+{
+    const char* Name;
+    const char* Help;
+    // applied on scrape, e.g. to turn nanoseconds into seconds
+    double Scale;
+};
+
+static constexpr MetricInfo kCounterInfo[kCounters] =
+{
+    {"crobots_matches_total", "Matches finished", 1.0},
+    {"crobots_ticks_total", "Ticks simulated in this process", 1.0},
+    {"crobots_robot_failures_total", "Robots that failed to load", 1.0},
+    {"crobots_worker_drops_total", "Workers lost with work in hand", 1.0},
+    {"crobots_busy_seconds_total", "Time spent playing matches in this process, summed over threads", 1e-9},
+};
+
+static constexpr MetricInfo kGaugeInfo[kGauges] =
+{
+    {"crobots_queued_matches", "Matches scheduled but not yet finished", 1.0},
+    {"crobots_workers", "Workers playing matches", 1.0},
+    {"crobots_busy_workers", "Workers with work in hand", 1.0},
+    {"crobots_arena_peak_bytes", "Most bytes live at once in the last match's arena", 1.0},
+    {"crobots_arena_reserved_bytes", "Bytes reserved by the arena", 1.0},
+};
+
+// written by one thread only, so updates are a plain load and store rather than a locked add
+struct Block
+{
+    std::atomic<uint64_t> Counters[kCounters];
+    std::atomic<uint64_t> Buckets[kRobots][kBuckets];
+    std::atomic<uint64_t> Sums[kRobots];
+};
+
+static std::atomic<bool> gEnabled;
+static std::atomic<int64_t> gGauges[kGauges];
+static std::mutex gMutex;
+static std::vector<std::unique_ptr<Block>> gBlocks;
+static std::vector<std::string> gRobots;
+static uint64_t gStart;
+
+static void Bump(std::atomic<uint64_t>& value, uint64_t delta)
+{
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+static Block* GetBlock()
+{
+    // blocks outlive their threads so nothing counted is ever lost
+    thread_local Block* tBlock = nullptr;
+    if (!tBlock)
+    {
+        std::lock_guard lock{gMutex};
+        tBlock = gBlocks.emplace_back(std::make_unique<Block>()).get();
+    }
+    return tBlock;
+}
+
+static void Append(std::string& text, const char* format, ...)
+{
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int count = std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    text.append(line, std::clamp<int>(count, 0, sizeof(line) - 1));
+}
+
+static void AppendHeader(std::string& text, const char* name, const char* help, const char* type)
+{
+    Append(text, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// label values only need backslashes, quotes and newlines escaped
+static std::string Escape(const std::string_view& value)
+{
+    std::string escaped;
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+        {
+            escaped += '\\';
+        }
+        if (c == '\n')
+        {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void Metrics::Enable()
+{
+    if (!gEnabled.exchange(true))
+    {
+        gStart = SDL_GetTicksNS();
+    }
+}
+
+bool Metrics::IsEnabled()
+{
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+void Metrics::Add(MetricCounter counter, uint64_t value)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    Bump(GetBlock()->Counters[int(counter)], value);
+}
+
+void Metrics::Set(MetricGauge gauge, int64_t value)
+{
+    gGauges[int(gauge)].store(value, std::memory_order_relaxed);
+}
+
+int Metrics::GetRobot(const std::string_view& name)
+{
+    if (!IsEnabled())
+    {
+        return -1;
+    }
+    std::lock_guard lock{gMutex};
+    auto it = std::find(gRobots.begin(), gRobots.end(), name);
+    if (it != gRobots.end())
+    {
+        return it - gRobots.begin();
+    }
+    if (gRobots.size() == kRobots)
+    {
+        return -1;
+    }
+    gRobots.emplace_back(name);
+    return gRobots.size() - 1;
+}
+
+void Metrics::Observe(int robot, uint64_t nanoseconds)
+{
+    if (robot < 0)
+    {
+        return;
+    }
+    Block* block = GetBlock();
+    int bucket = std::min<int>(std::bit_width(nanoseconds / 1000), kBuckets - 1);
+    Bump(block->Buckets[robot][bucket], 1);
+    Bump(block->Sums[robot], nanoseconds);
+}
+
+void Metrics::Write(std::string& text)
+{
+    text.clear();
+    uint64_t counters[kCounters]{};
+    std::vector<std::string> robots;
+    std::vector<uint64_t> buckets;
+    std::vector<uint64_t> sums;
+    {
+        std::lock_guard lock{gMutex};
+        robots = gRobots;
+        buckets.assign(robots.size() * kBuckets, 0);
+        sums.assign(robots.size(), 0);
+        for (const std::unique_ptr<Block>& block : gBlocks)
+        {
+            for (int i = 0; i < kCounters; i++)
+            {
+                counters[i] += block->Counters[i].load(std::memory_order_relaxed);
+            }
+            for (int i = 0; i < robots.size(); i++)
+            {
+                for (int j = 0; j < kBuckets; j++)
+                {
+                    buckets[i * kBuckets + j] += block->Buckets[i][j].load(std::memory_order_relaxed);
+                }
+                sums[i] += block->Sums[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    for (int i = 0; i < kCounters; i++)
+    {
+        const MetricInfo& info = kCounterInfo[i];
+        AppendHeader(text, info.Name, info.Help, "counter");
+        Append(text, "%s %.17g\n", info.Name, counters[i] * info.Scale);
+    }
+    for (int i = 0; i < kGauges; i++)
+    {
+        const MetricInfo& info = kGaugeInfo[i];
+        AppendHeader(text, info.Name, info.Help, "gauge");
+        Append(text, "%s %.17g\n", info.Name, gGauges[i].load(std::memory_order_relaxed) * info.Scale);
+    }
+    AppendHeader(text, "crobots_uptime_seconds", "Time since metrics were enabled", "gauge");
+    Append(text, "crobots_uptime_seconds %.3f\n", (SDL_GetTicksNS() - gStart) / 1e9);
+#ifndef _WIN32
+    rusage usage;
+    if (!getrusage(RUSAGE_SELF, &usage))
+    {
+#ifdef __APPLE__
+        uint64_t rss = usage.ru_maxrss;
+#else
+        uint64_t rss = uint64_t(usage.ru_maxrss) * 1024;
+#endif
+        AppendHeader(text, "crobots_max_resident_bytes", "Peak resident memory of the process", "gauge");
+        Append(text, "crobots_max_resident_bytes %llu\n", (unsigned long long) rss);
+    }
+#endif
+    AppendHeader(text, "crobots_robot_update_seconds", "Time a robot's update took, per tick", "histogram");
+    for (int i = 0; i < robots.size(); i++)
+    {
+        std::string name = Escape(robots[i]);
+        uint64_t count = 0;
+        for (int j = 0; j < kBuckets; j++)
+        {
+            count += buckets[i * kBuckets + j];
+            if (j == kBuckets - 1)
+            {
+                Append(text, "crobots_robot_update_seconds_bucket{robot=\"%s\",le=\"+Inf\"} %llu\n", name.data(),
+                    (unsigned long long) count);
+            }
+            else
+            {
+                // bucket j holds everything under 2^j microseconds
+                Append(text, "crobots_robot_update_seconds_bucket{robot=\"%s\",le=\"%g\"} %llu\n", name.data(),
+                    double(uint64_t(1) << j) * 1e-6, (unsigned long long) count);
+            }
+        }
+        Append(text, "crobots_robot_update_seconds_sum{robot=\"%s\"} %.9f\n", name.data(), sums[i] / 1e9);
+        Append(text, "crobots_robot_update_seconds_count{robot=\"%s\"} %llu\n", name.data(), (unsigned long long) count);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class MetricCounter : uint8_t
+{
+    Matches,
+    Ticks,
+    // robots that failed to load or reset
+    Failures,
+    // workers that disconnected or crashed with a shard in hand
+    Drops,
+    // nanoseconds spent playing matches, summed over threads
+    Busy,
+    Count,
+};
+
+enum class MetricGauge : uint8_t
+{
+    // matches scheduled but not yet finished
+    Queued,
+    Workers,
+    // workers with a match or shard in hand
+    BusyWorkers,
+    ArenaPeak,
+    ArenaReserved,
+    Count,
+};
+
+// process wide counters, gauges and per robot update latency histograms. counters and histograms are kept
+// per thread and only summed when scraped, so recording costs a relaxed load and store. everything is a no-op
+// until enabled, which should be before any engine is reset so robots get a histogram
+class Metrics
+{
+public:
+    static void Enable();
+    static bool IsEnabled();
+    static void Add(MetricCounter counter, uint64_t value = 1);
+    static void Set(MetricGauge gauge, int64_t value);
+    // histogram slot for a robot's update latency, -1 if disabled or out of slots
+    static int GetRobot(const std::string_view& name);
+    static void Observe(int robot, uint64_t nanoseconds);
+    // everything so far in the prometheus text format
+    static void Write(std::string& text);
+};
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include <SDL3/SDL.h>
+#include <crobots++/abi.h>
+#include <crobots++/robot.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "module.hpp"
+
+static constexpr const char* kNewRobot = "NewRobot";
+
+struct Module
+{
+    SDL_SharedObject* Object;
+    NewRobotFunction Function;
+    crobots_create_function Create;
+};
+
+// runs a robot built against the c interface behind the same interface as native ones
+class AbiAdapter : public crobots::IRobot
+{
+public:
+    AbiAdapter()
+        : Robot{}
+        , Host{}
+        , Observation{}
+        , Command{}
+        , Ticks{0}
+    {
+    }
+
+    ~AbiAdapter()
+    {
+        if (Robot.destroy)
+        {
+            Robot.destroy(Robot.instance);
+        }
+    }
+
+    bool Init(crobots_create_function create)
+    {
+        Host.context = this;
+        Host.get_parameter = DeclareParameter;
+        if (!create(CROBOTS_ABI_VERSION, &Host, &Robot) || !Robot.update)
+        {
+            Robot = {};
+            return false;
+        }
+        return true;
+    }
+
+    void Update(float deltaTime) override
+    {
+        // flags and the scan result carry over from the previous tick's command
+        Observation.version = CROBOTS_ABI_VERSION;
+        Observation.tick = Ticks++;
+        Observation.delta_time = deltaTime;
+        Observation.time = GetTime();
+        Observation.x = GetX();
+        Observation.y = GetY();
+        Observation.speed = Command.speed;
+        Observation.damage = GetDamage();
+        Observation.heat = GetHeat();
+        float speed = Command.speed;
+        Command = {};
+        Command.speed = speed;
+        Robot.update(Robot.instance, &Observation, &Command);
+        SetSpeed(Command.speed);
+        if (Command.flags & CROBOTS_COMMAND_FIRE)
+        {
+            Fire(Command.fire_angle, Command.fire_range);
+        }
+        Observation.flags &= ~CROBOTS_SCAN_FOUND;
+        if (Command.flags & CROBOTS_COMMAND_SCAN)
+        {
+            std::optional<float> distance = Scan(Command.scan_angle, Command.scan_width);
+            if (distance)
+            {
+                Observation.flags |= CROBOTS_SCAN_FOUND;
+                Observation.scan_distance = *distance;
+            }
+        }
+        if (Command.flags & CROBOTS_COMMAND_COOL_DOWN)
+        {
+            CoolDown();
+        }
+    }
+
+private:
+    static float DeclareParameter(void* context, const char* name, float value, float min, float max)
+    {
+        return static_cast<AbiAdapter*>(context)->GetParameter(name, value, min, max);
+    }
+
+    crobots_robot Robot;
+    crobots_host Host;
+    crobots_observation Observation;
+    crobots_command Command;
+    uint64_t Ticks;
+};
+
+static std::mutex gMutex;
+static std::unordered_map<std::string, Module> gModules;
+static std::filesystem::path gDirectory;
+
+static bool Find(const std::string_view& name, Module& module)
+{
+    std::lock_guard lock{gMutex};
+    auto iterator = gModules.find(std::string{name});
+    if (iterator != gModules.end())
+    {
+        module = iterator->second;
+        return true;
+    }
+    std::filesystem::path path = gDirectory.empty() ? std::filesystem::path{SDL_GetBasePath()} : gDirectory;
+    path /= name;
+#if defined(SDL_PLATFORM_WIN32)
+    path.replace_extension(".dll");
+#elif defined(SDL_PLATFORM_LINUX)
+    path.replace_extension(".so");
+#elif defined(SDL_PLATFORM_APPLE)
+    path.replace_extension(".dylib");
+#endif
+    SDL_SharedObject* object = SDL_LoadObject(path.string().data());
+    if (!object)
+    {
+        SDL_Log("Failed to load robot: %s, %s", path.string().data(), SDL_GetError());
+        return false;
+    }
+    module.Object = object;
+    module.Function = reinterpret_cast<NewRobotFunction>(SDL_LoadFunction(object, kNewRobot));
+    module.Create = reinterpret_cast<crobots_create_function>(SDL_LoadFunction(object, CROBOTS_CREATE));
+    if (!module.Function && !module.Create)
+    {
+        SDL_Log("Failed to load %s or %s: %s, %s", kNewRobot, CROBOTS_CREATE, name.data(), SDL_GetError());
+        SDL_UnloadObject(object);
+        return false;
+    }
+    gModules.emplace(std::string{name}, module);
+    return true;
+}
+
+bool ModuleRegistry::Load(const std::string_view& name)
+{
+    Module module;
+    return Find(name, module);
+}
+
+void ModuleRegistry::Register(const std::string_view& name, NewRobotFunction function)
+{
+    std::lock_guard lock{gMutex};
+    gModules.insert_or_assign(std::string{name}, Module{nullptr, function, nullptr});
+}
+
+void ModuleRegistry::SetDirectory(const std::filesystem::path& directory)
+{
+    std::lock_guard lock{gMutex};
+    gDirectory = directory;
+}
+
+crobots::IRobot* ModuleRegistry::Create(const std::string_view& name, const std::shared_ptr<crobots::RobotContext>& context)
+{
+    Module module;
+    if (!Find(name, module))
+    {
+        return nullptr;
+    }
+    if (module.Function)
+    {
+        return module.Function(context);
+    }
+    std::unique_ptr<AbiAdapter> robot{static_cast<AbiAdapter*>(crobots::IRobot::Create<AbiAdapter>(context))};
+    if (!robot->Init(module.Create))
+    {
+        SDL_Log("Failed to create robot: %s", name.data());
+        return nullptr;
+    }
+    return robot.release();
+}
+
+void ModuleRegistry::Unload()
+{
+    std::lock_guard lock{gMutex};
+    for (auto& [name, module] : gModules)
+    {
+        if (module.Object)
+        {
+            SDL_UnloadObject(module.Object);
+        }
+    }
+    gModules.clear();
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <crobots++/abi.h>
+#include <crobots++/robot.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace crobots
+{
+
+class RobotContext;
+
+}
+
+using NewRobotFunction = crobots::IRobot*(*)(const std::shared_ptr<crobots::RobotContext>& context);
+
+// process wide cache of robot modules so each one is opened once no matter how many matches use it.
+// modules either export NewRobot or the versioned c entry point from abi.h
+class ModuleRegistry
+{
+public:
+    static bool Load(const std::string_view& name);
+    // makes name resolve to a robot compiled into the host instead of a module on disk
+    static void Register(const std::string_view& name, NewRobotFunction function);
+    // modules are looked up next to the executable unless told otherwise
+    static void SetDirectory(const std::filesystem::path& directory);
+    // robots built against the c interface are wrapped so the engine drives every robot the same way
+    static crobots::IRobot* Create(const std::string_view& name, const std::shared_ptr<crobots::RobotContext>& context);
+    // every robot created from a module must be destroyed before unloading
+    static void Unload();
+};
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include <memory>
+#include <string_view>
+
+#include "batch.hpp"
+#include "box2d_physics.hpp"
+#include "physics.hpp"
+
+std::unique_ptr<IPhysics> CreatePhysics(PhysicsType type)
+{
+    if (type == PhysicsType::Batch)
+    {
+        return std::make_unique<BatchPhysics>();
+    }
+    return std::make_unique<Box2DPhysics>();
+}
+
+bool GetPhysicsType(const std::string_view& name, PhysicsType& type)
+{
+    if (name == "box2d")
+    {
+        type = PhysicsType::Box2D;
+        return true;
+    }
+    if (name == "batch")
+    {
+        type = PhysicsType::Batch;
+        return true;
+    }
+    return false;
+}
\ No newline at end of file
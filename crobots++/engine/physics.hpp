@@ -0,0 +1,81 @@
+#pragma once
+
+#include <box2d/box2d.h>
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "map.hpp"
+#include "state.hpp"
+
+// bodies are indices into the backend's own storage. walls aren't bodies
+static constexpr int kNoBody = -1;
+// the same on every backend. robots are boxes this wide and projectiles circles this big around
+static constexpr float kRobotSize = 1.0f;
+static constexpr float kProjectileRadius = 0.1f;
+
+enum class PhysicsType : uint8_t
+{
+    // box2d, the reference the others are measured against
+    Box2D,
+    // robots as oriented unit boxes against the arena walls and circles against each other, stepped four
+    // bodies at a time. close to box2d rather than identical and only for the empty arena
+    Batch,
+};
+
+enum class BodyType : uint8_t
+{
+    Robot,
+    Projectile,
+};
+
+// two bodies starting to touch fast enough to count as a hit, or two bodies parting. either body is kNoBody
+// for a wall
+struct Contact
+{
+    int BodyA;
+    int BodyB;
+    b2Vec2 Point;
+    float ApproachSpeed;
+    bool Hit;
+};
+
+// the rigid body simulation under Engine. one world at a time, created around a map and torn down whole
+class IPhysics
+{
+public:
+    virtual ~IPhysics() = default;
+    // walls around the free space of layout, stretched to width across. false if the backend can't model it
+    virtual bool CreateWorld(const Map& layout, float width) = 0;
+    // destroys every body with it. harmless without a world
+    virtual void DestroyWorld() = 0;
+    virtual int CreateBody(BodyType type, const b2Transform& transform, const b2Vec2& velocity) = 0;
+    virtual void DestroyBody(int body) = 0;
+    // advances every body by timestep, applying and then clearing forces
+    virtual void Step(float timestep, int subSteps) = 0;
+    // from the last step
+    virtual const std::vector<Contact>& GetContacts() const = 0;
+    virtual b2Transform GetTransform(int body) const = 0;
+    virtual void SetTransform(int body, const b2Transform& transform) = 0;
+    virtual b2Vec2 GetLinearVelocity(int body) const = 0;
+    virtual void SetLinearVelocity(int body, const b2Vec2& velocity) = 0;
+    virtual float GetAngularVelocity(int body) const = 0;
+    virtual void SetAngularVelocity(int body, float velocity) = 0;
+    // a sleeping body doesn't move until something wakes it
+    virtual bool IsAwake(int body) const = 0;
+    virtual void SetAwake(int body, bool awake) = 0;
+    virtual float GetMass(int body) const = 0;
+    // wakes the body
+    virtual void ApplyForce(int body, const b2Vec2& force) = 0;
+    // every wall segment that could overlap bounds, and maybe a few that don't
+    virtual void GetWalls(const b2AABB& bounds, std::vector<b2Segment>& walls) const = 0;
+    // debug shapes into the state, only those within bounds unless it's nullptr
+    virtual void Draw(State& state, const b2AABB* bounds) const = 0;
+    virtual void GetProfile(TickProfile& profile) const = 0;
+};
+
+std::unique_ptr<IPhysics> CreatePhysics(PhysicsType type);
+// "box2d" or "batch"
+bool GetPhysicsType(const std::string_view& name, PhysicsType& type);
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// bounded single producer, single consumer ring
+template<typename T, uint32_t N>
+class SPSCQueue
+{
+    static_assert(N && !(N & (N - 1)), "Capacity must be a power of two");
+
+public:
+    SPSCQueue()
+        : Head{0}
+        , Tail{0}
+        , Data{}
+    {
+    }
+
+    SPSCQueue(const SPSCQueue& other) = delete;
+    SPSCQueue& operator=(const SPSCQueue& other) = delete;
+
+    // producer only. returns false when full
+    bool Push(const T& value)
+    {
+        uint32_t head = Head.load(std::memory_order_relaxed);
+        if (head - Tail.load(std::memory_order_acquire) == N)
+        {
+            return false;
+        }
+        Data[head & (N - 1)] = value;
+        Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only. returns false when empty
+    bool Pop(T& value)
+    {
+        uint32_t tail = Tail.load(std::memory_order_relaxed);
+        if (tail == Head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = Data[tail & (N - 1)];
+        Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<uint32_t> Head;
+    alignas(64) std::atomic<uint32_t> Tail;
+    alignas(64) T Data[N];
+};
\ No newline at end of file
@@ -16,10 +16,13 @@
 
 #include "buffer.hpp"
 #include "camera.hpp"
-#include "engine.hpp"
+#include "hud.hpp"
 #include "renderer.hpp"
+#include "state.hpp"
 
 static constexpr glm::vec3 kUp{0.0f, 1.0f, 0.0f};
+// half extents of a unit cube under any rotation about the up axis
+static constexpr glm::vec3 kRobotExtents{0.7072f, 0.5f, 0.7072f};
 
 Renderer::Renderer()
     : Window{nullptr}
@@ -28,10 +31,18 @@ Renderer::Renderer()
     , InstancedPipeline{nullptr}
     , LinePipeline{nullptr}
     , SolidPolygonPipeline{nullptr}
+    , HudPipeline{nullptr}
     , CubeBuffer{nullptr}
     , InstanceBuffer{}
     , LineBuffer{}
     , SolidPolygonBuffer{}
+    , HudBuffer{}
+    , Centers{}
+    , Visible{}
+    , Overlay{}
+    , Profile{}
+    , FrameTime{0}
+    , ShowHud{false}
 {
 }
 
@@ -82,22 +93,25 @@ bool Renderer::Init(SDL_Window* window)
         SDL_Log("Failed to create solid polygon pipeline");
         return false;
     }
+    HudPipeline = CreateHudPipeline();
+    if (!HudPipeline)
+    {
+        SDL_Log("Failed to create hud pipeline");
+        return false;
+    }
     SDL_DestroyProperties(props);
-    DebugDraw = b2DefaultDebugDraw();
-    DebugDraw.context = this;
-    DebugDraw.DrawSolidPolygonFcn = DrawSolidPolygon;
-    DebugDraw.DrawSegmentFcn = DrawSegment;
-    DebugDraw.drawShapes = true;
     return true;
 }
 
 void Renderer::Destroy()
 {
+    HudBuffer.Destroy(Device);
     SolidPolygonBuffer.Destroy(Device);
     LineBuffer.Destroy(Device);
     InstanceBuffer.Destroy(Device);
     SDL_ReleaseGPUTexture(Device, DepthTexture);
     SDL_ReleaseGPUBuffer(Device, CubeBuffer);
+    SDL_ReleaseGPUGraphicsPipeline(Device, HudPipeline);
     SDL_ReleaseGPUGraphicsPipeline(Device, SolidPolygonPipeline);
     SDL_ReleaseGPUGraphicsPipeline(Device, LinePipeline);
     SDL_ReleaseGPUGraphicsPipeline(Device, InstancedPipeline);
@@ -106,9 +120,21 @@ void Renderer::Destroy()
     SDL_Quit();
 }
 
-void Renderer::Draw(const Engine& engine, Camera& camera)
+void Renderer::Draw(const State& state, Camera& camera)
 {
+    uint64_t time1 = SDL_GetTicksNS();
+    uint64_t time2;
+    // every phase is stamped as it ends. the totals describe the previous frame when the hud reads them
+    auto measure = [&](uint64_t& phase)
+    {
+        time2 = SDL_GetTicksNS();
+        phase = time2 - time1;
+        time1 = time2;
+    };
+    Profile.Frame = FrameTime ? time1 - FrameTime : 0;
+    FrameTime = time1;
     SDL_WaitForGPUSwapchain(Device, Window);
+    measure(Profile.Wait);
     SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(Device);
     if (!commandBuffer)
     {
@@ -150,20 +176,44 @@ void Renderer::Draw(const Engine& engine, Camera& camera)
         }
         camera.SetSize(width, height);
     }
+    measure(Profile.Acquire);
     camera.Update();
-    if (engine.GetDebug())
+    for (const DebugPolygon& polygon : state.Polygons)
+    {
+        DrawSolidPolygon(polygon);
+    }
+    for (const DebugSegment& segment : state.Segments)
+    {
+        DrawSegment(segment);
+    }
+    Centers.clear();
+    for (const RobotState& robot : state.Robots)
     {
-        b2World_Draw(engine.GetWorldID(), &DebugDraw);
+        Centers.emplace_back(robot.Position.x, 0.0f, robot.Position.y);
     }
-    for (const Robot& robot : engine.GetRobots())
+    Visible.resize(Centers.size());
+    camera.GetFrustum().Cull(Centers.data(), kRobotExtents, Centers.size(), Visible.data());
+    for (int i = 0; i < state.Robots.size(); i++)
     {
-        b2Vec2 position = b2Body_GetPosition(robot.BodyID);
-        b2Rot rotation = b2Body_GetRotation(robot.BodyID);
-        glm::mat4 r = glm::rotate(glm::mat4(1.0f), -b2Rot_GetAngle(rotation), kUp);
-        glm::mat4 t = glm::translate(glm::mat4(1.0f), glm::vec3(position.x, 0.0f, position.y));
+        if (!Visible[i])
+        {
+            continue;
+        }
+        const RobotState& robot = state.Robots[i];
+        glm::mat4 r = glm::rotate(glm::mat4(1.0f), -b2Rot_GetAngle(robot.Rotation), kUp);
+        glm::mat4 t = glm::translate(glm::mat4(1.0f), glm::vec3(robot.Position.x, 0.0f, robot.Position.y));
         glm::mat4 transform = t * r;
         InstanceBuffer.Emplace(Device, t * r);
     }
+    if (ShowHud)
+    {
+        Overlay.Build(Profile, state, width, height);
+        for (const HudVertex& vertex : Overlay.GetVertices())
+        {
+            HudBuffer.Emplace(Device, vertex);
+        }
+    }
+    measure(Profile.Build);
     SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
     if (!copyPass)
     {
@@ -174,7 +224,18 @@ void Renderer::Draw(const Engine& engine, Camera& camera)
     InstanceBuffer.Upload(Device, copyPass);
     LineBuffer.Upload(Device, copyPass);
     SolidPolygonBuffer.Upload(Device, copyPass);
+    HudBuffer.Upload(Device, copyPass);
     SDL_EndGPUCopyPass(copyPass);
+    measure(Profile.Upload);
+    // the copy pass
+    Profile.Passes = 1;
+    Profile.Draws = 0;
+    Profile.Uploaded = InstanceBuffer.GetSize() * sizeof(Instance) + LineBuffer.GetSize() * sizeof(ColorVertex) +
+        SolidPolygonBuffer.GetSize() * sizeof(TransformedVertex) + HudBuffer.GetSize() * sizeof(HudVertex);
+    Profile.InstanceCapacity = InstanceBuffer.GetCapacity() * sizeof(Instance);
+    Profile.LineCapacity = LineBuffer.GetCapacity() * sizeof(ColorVertex);
+    Profile.SolidPolygonCapacity = SolidPolygonBuffer.GetCapacity() * sizeof(TransformedVertex);
+    Profile.HudCapacity = HudBuffer.GetCapacity() * sizeof(HudVertex);
     if (InstanceBuffer.GetSize())
     {
         SDL_GPUColorTargetInfo colorInfo{};
@@ -201,6 +262,8 @@ void Renderer::Draw(const Engine& engine, Camera& camera)
         SDL_BindGPUVertexBuffers(renderPass, 0, vertexBuffers, 2);
         SDL_PushGPUVertexUniformData(commandBuffer, 0, &camera.GetViewProj(), 64);
         SDL_DrawGPUPrimitives(renderPass, 36, InstanceBuffer.GetSize(), 0, 0);
+        Profile.Passes++;
+        Profile.Draws++;
         SDL_EndGPURenderPass(renderPass);
     }
     if (SolidPolygonBuffer.GetSize())
@@ -228,6 +291,8 @@ void Renderer::Draw(const Engine& engine, Camera& camera)
         SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBuffer, 1);
         SDL_PushGPUVertexUniformData(commandBuffer, 0, &camera.GetViewProj(), 64);
         SDL_DrawGPUPrimitives(renderPass, SolidPolygonBuffer.GetSize(), 1, 0, 0);
+        Profile.Passes++;
+        Profile.Draws++;
         SDL_EndGPURenderPass(renderPass);
     }
     if (LineBuffer.GetSize())
@@ -255,9 +320,47 @@ void Renderer::Draw(const Engine& engine, Camera& camera)
         SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBuffer, 1);
         SDL_PushGPUVertexUniformData(commandBuffer, 0, &camera.GetViewProj(), 64);
         SDL_DrawGPUPrimitives(renderPass, LineBuffer.GetSize(), 1, 0, 0);
+        Profile.Passes++;
+        Profile.Draws++;
+        SDL_EndGPURenderPass(renderPass);
+    }
+    if (HudBuffer.GetSize())
+    {
+        SDL_GPUColorTargetInfo colorInfo{};
+        colorInfo.texture = swapchainTexture;
+        colorInfo.load_op = SDL_GPU_LOADOP_LOAD;
+        colorInfo.store_op = SDL_GPU_STOREOP_STORE;
+        SDL_GPURenderPass* renderPass = SDL_BeginGPURenderPass(commandBuffer, &colorInfo, 1, nullptr);
+        if (!renderPass)
+        {
+            SDL_Log("Failed to begin render pass: %s", SDL_GetError());
+            SDL_SubmitGPUCommandBuffer(commandBuffer);
+            return;
+        }
+        // pixels with the origin at the top left
+        glm::mat4 ortho = glm::ortho(0.0f, float(width), float(height), 0.0f, -1.0f, 1.0f);
+        SDL_GPUBufferBinding vertexBuffer{};
+        vertexBuffer.buffer = HudBuffer.GetBuffer();
+        SDL_BindGPUGraphicsPipeline(renderPass, HudPipeline);
+        SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBuffer, 1);
+        SDL_PushGPUVertexUniformData(commandBuffer, 0, &ortho, 64);
+        SDL_DrawGPUPrimitives(renderPass, HudBuffer.GetSize(), 1, 0, 0);
+        Profile.Passes++;
+        Profile.Draws++;
         SDL_EndGPURenderPass(renderPass);
     }
     SDL_SubmitGPUCommandBuffer(commandBuffer);
+    measure(Profile.Render);
+}
+
+void Renderer::SetHud(bool hud)
+{
+    ShowHud = hud;
+}
+
+bool Renderer::GetHud() const
+{
+    return ShowHud;
 }
 
 SDL_GPUShader* Renderer::LoadShader(const std::string_view &name)
@@ -548,6 +651,52 @@ SDL_GPUGraphicsPipeline* Renderer::CreateSolidPolygonPipeline()
     return pipeline;
 }
 
+SDL_GPUGraphicsPipeline* Renderer::CreateHudPipeline()
+{
+    SDL_GPUShader* fragShader = LoadShader("color.frag");
+    SDL_GPUShader* vertShader = LoadShader("color.vert");
+    if (!fragShader || !vertShader)
+    {
+        SDL_Log("Failed to load shader(s)");
+        return nullptr;
+    }
+    SDL_GPUColorTargetDescription targets[1]{};
+    SDL_GPUVertexBufferDescription buffers[1]{};
+    SDL_GPUVertexAttribute attribs[2]{};
+    targets[0].format = SDL_GetGPUSwapchainTextureFormat(Device, Window);
+    buffers[0].slot = 0;
+    buffers[0].pitch = sizeof(float) * 3 + sizeof(uint32_t);
+    buffers[0].input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
+    buffers[0].instance_step_rate = 0;
+    attribs[0].location = 0;
+    attribs[0].format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
+    attribs[0].offset = 0;
+    attribs[0].buffer_slot = 0;
+    attribs[1].location = 1;
+    attribs[1].format = SDL_GPU_VERTEXELEMENTFORMAT_UINT;
+    attribs[1].offset = sizeof(float) * 3;
+    attribs[1].buffer_slot = 0;
+    SDL_GPUGraphicsPipelineCreateInfo info{};
+    info.vertex_shader = vertShader;
+    info.fragment_shader = fragShader;
+    info.target_info.color_target_descriptions = targets;
+    info.target_info.num_color_targets = 1;
+    info.vertex_input_state.vertex_buffer_descriptions = buffers;
+    info.vertex_input_state.num_vertex_buffers = 1;
+    info.vertex_input_state.vertex_attributes = attribs;
+    info.vertex_input_state.num_vertex_attributes = 2;
+    info.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+    SDL_GPUGraphicsPipeline* pipeline = SDL_CreateGPUGraphicsPipeline(Device, &info);
+    if (!pipeline)
+    {
+        SDL_Log("Failed to create hud pipeline: %s", SDL_GetError());
+        return nullptr;
+    }
+    SDL_ReleaseGPUShader(Device, fragShader);
+    SDL_ReleaseGPUShader(Device, vertShader);
+    return pipeline;
+}
+
 SDL_GPUBuffer* Renderer::CreateCubeBuffer()
 {
     static constexpr NormalVertex kVertices[] =
@@ -646,41 +795,39 @@ SDL_GPUBuffer* Renderer::CreateCubeBuffer()
     return buffer;
 }
 
-void Renderer::DrawSolidPolygon(b2Transform transform, const b2Vec2* vertices, int count, float radius, b2HexColor color, void* context)
+void Renderer::DrawSolidPolygon(const DebugPolygon& polygon)
 {
-    Renderer* renderer = static_cast<Renderer*>(context);
-    for (int i = 1; i < count - 1; i++)
+    for (int i = 1; i < polygon.Count - 1; i++)
     {
         const int kIndices[3] = {0, i, i + 1};
         for (int j = 0; j < 3; j++)
         {
             TransformedVertex vertex;
-            vertex.Vertex.Position.x = vertices[kIndices[j]].x;
+            vertex.Vertex.Position.x = polygon.Vertices[kIndices[j]].x;
             vertex.Vertex.Position.y = 0.0f;
-            vertex.Vertex.Position.z = vertices[kIndices[j]].y;
-            vertex.Vertex.Color = color;
-            vertex.Transform.Position.x = transform.p.x;
-            vertex.Transform.Position.y = transform.p.y;
-            vertex.Transform.Rotation.x = transform.q.s;
-            vertex.Transform.Rotation.y = transform.q.c;
-            renderer->SolidPolygonBuffer.Emplace(renderer->Device, vertex);
+            vertex.Vertex.Position.z = polygon.Vertices[kIndices[j]].y;
+            vertex.Vertex.Color = polygon.Color;
+            vertex.Transform.Position.x = polygon.Transform.p.x;
+            vertex.Transform.Position.y = polygon.Transform.p.y;
+            vertex.Transform.Rotation.x = polygon.Transform.q.s;
+            vertex.Transform.Rotation.y = polygon.Transform.q.c;
+            SolidPolygonBuffer.Emplace(Device, vertex);
         }
     }
 }
 
-void Renderer::DrawSegment(b2Vec2 p1, b2Vec2 p2, b2HexColor color, void* context)
+void Renderer::DrawSegment(const DebugSegment& segment)
 {
-    Renderer* renderer = static_cast<Renderer*>(context);
     ColorVertex vertex0;
-    vertex0.Position.x = p1.x;
+    vertex0.Position.x = segment.P1.x;
     vertex0.Position.y = 0.0f;
-    vertex0.Position.z = p1.y;
-    vertex0.Color = color;
+    vertex0.Position.z = segment.P1.y;
+    vertex0.Color = segment.Color;
     ColorVertex vertex1;
-    vertex1.Position.x = p2.x;
+    vertex1.Position.x = segment.P2.x;
     vertex1.Position.y = 0.0f;
-    vertex1.Position.z = p2.y;
-    vertex1.Color = color;
-    renderer->LineBuffer.Emplace(renderer->Device, vertex0);
-    renderer->LineBuffer.Emplace(renderer->Device, vertex1);
+    vertex1.Position.z = segment.P2.y;
+    vertex1.Color = segment.Color;
+    LineBuffer.Emplace(Device, vertex0);
+    LineBuffer.Emplace(Device, vertex1);
 }
\ No newline at end of file
@@ -6,11 +6,15 @@
 
 #include <cstdint>
 #include <string_view>
+#include <vector>
 
 #include "buffer.hpp"
+#include "hud.hpp"
 
 class Camera;
-class Engine;
+struct DebugPolygon;
+struct DebugSegment;
+struct State;
 
 class Renderer
 {
@@ -18,16 +22,19 @@ public:
     Renderer();
     bool Init(SDL_Window* window);
     void Destroy();
-    void Draw(const Engine& engine, Camera& camera);
+    void Draw(const State& state, Camera& camera);
+    void SetHud(bool hud);
+    bool GetHud() const;
 
 private:
     SDL_GPUShader* LoadShader(const std::string_view &name);
     SDL_GPUGraphicsPipeline* CreateInstancedPipeline();
     SDL_GPUGraphicsPipeline* CreateLinePipeline();
     SDL_GPUGraphicsPipeline* CreateSolidPolygonPipeline();
+    SDL_GPUGraphicsPipeline* CreateHudPipeline();
     SDL_GPUBuffer* CreateCubeBuffer();
-    static void DrawSolidPolygon(b2Transform transform, const b2Vec2* vertices, int count, float radius, b2HexColor color, void* context);
-    static void DrawSegment(b2Vec2 p1, b2Vec2 p2, b2HexColor color, void* context);
+    void DrawSolidPolygon(const DebugPolygon& polygon);
+    void DrawSegment(const DebugSegment& segment);
 
     struct ColorVertex
     {
@@ -65,9 +72,17 @@ private:
     SDL_GPUGraphicsPipeline* InstancedPipeline;
     SDL_GPUGraphicsPipeline* LinePipeline;
     SDL_GPUGraphicsPipeline* SolidPolygonPipeline;
+    SDL_GPUGraphicsPipeline* HudPipeline;
     SDL_GPUBuffer* CubeBuffer;
     DynamicBuffer<Instance, SDL_GPU_BUFFERUSAGE_VERTEX> InstanceBuffer;
     DynamicBuffer<ColorVertex, SDL_GPU_BUFFERUSAGE_VERTEX> LineBuffer;
     DynamicBuffer<TransformedVertex, SDL_GPU_BUFFERUSAGE_VERTEX> SolidPolygonBuffer;
-    b2DebugDraw DebugDraw;
+    DynamicBuffer<HudVertex, SDL_GPU_BUFFERUSAGE_VERTEX> HudBuffer;
+    std::vector<glm::vec3> Centers;
+    std::vector<uint8_t> Visible;
+    Hud Overlay;
+    // filled in over a frame and shown on the next one
+    FrameProfile Profile;
+    uint64_t FrameTime;
+    bool ShowHud;
 };
\ No newline at end of file
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// just enough of a 4-wide vector type for kernels to be written once for every target. the neon version
+// needs aarch64 for division, square roots and horizontal reductions, so 32 bit arm takes the scalar one.
+// there's no 8-wide avx2 version. it would only be picked with -mavx2, which nothing in the build sets since
+// the binaries have to run on any x86-64, and there's no runtime dispatch to choose one per machine
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CROBOTS_SSE
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CROBOTS_NEON
+#endif
+
+static constexpr int kLanes = 4;
+
+#if defined(CROBOTS_SSE)
+using Float4 = __m128;
+using Mask4 = __m128;
+
+inline Float4 Load(const float* data)
+{
+    return _mm_loadu_ps(data);
+}
+
+inline void Store(float* data, Float4 value)
+{
+    _mm_storeu_ps(data, value);
+}
+
+inline Float4 Set(float value)
+{
+    return _mm_set1_ps(value);
+}
+
+inline Float4 Add(Float4 a, Float4 b)
+{
+    return _mm_add_ps(a, b);
+}
+
+inline Float4 Sub(Float4 a, Float4 b)
+{
+    return _mm_sub_ps(a, b);
+}
+
+inline Float4 Mul(Float4 a, Float4 b)
+{
+    return _mm_mul_ps(a, b);
+}
+
+inline Float4 Div(Float4 a, Float4 b)
+{
+    return _mm_div_ps(a, b);
+}
+
+inline Float4 Sqrt(Float4 a)
+{
+    return _mm_sqrt_ps(a);
+}
+
+inline Float4 Min(Float4 a, Float4 b)
+{
+    return _mm_min_ps(a, b);
+}
+
+inline Float4 Max(Float4 a, Float4 b)
+{
+    return _mm_max_ps(a, b);
+}
+
+inline Float4 Abs(Float4 a)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+}
+
+inline float Sum(Float4 a)
+{
+    __m128 pairs = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+inline Mask4 Less(Float4 a, Float4 b)
+{
+    return _mm_cmplt_ps(a, b);
+}
+
+inline Mask4 And(Mask4 a, Mask4 b)
+{
+    return _mm_and_ps(a, b);
+}
+
+inline Mask4 Or(Mask4 a, Mask4 b)
+{
+    return _mm_or_ps(a, b);
+}
+
+inline Float4 Select(Mask4 mask, Float4 a, Float4 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// one bit per lane, lane 0 lowest
+inline int GetBits(Mask4 mask)
+{
+    return _mm_movemask_ps(mask);
+}
+#elif defined(CROBOTS_NEON)
+using Float4 = float32x4_t;
+using Mask4 = uint32x4_t;
+
+inline Float4 Load(const float* data)
+{
+    return vld1q_f32(data);
+}
+
+inline void Store(float* data, Float4 value)
+{
+    vst1q_f32(data, value);
+}
+
+inline Float4 Set(float value)
+{
+    return vdupq_n_f32(value);
+}
+
+inline Float4 Add(Float4 a, Float4 b)
+{
+    return vaddq_f32(a, b);
+}
+
+inline Float4 Sub(Float4 a, Float4 b)
+{
+    return vsubq_f32(a, b);
+}
+
+inline Float4 Mul(Float4 a, Float4 b)
+{
+    return vmulq_f32(a, b);
+}
+
+inline Float4 Div(Float4 a, Float4 b)
+{
+    return vdivq_f32(a, b);
+}
+
+inline Float4 Sqrt(Float4 a)
+{
+    return vsqrtq_f32(a);
+}
+
+inline Float4 Min(Float4 a, Float4 b)
+{
+    return vminq_f32(a, b);
+}
+
+inline Float4 Max(Float4 a, Float4 b)
+{
+    return vmaxq_f32(a, b);
+}
+
+inline Float4 Abs(Float4 a)
+{
+    return vabsq_f32(a);
+}
+
+inline float Sum(Float4 a)
+{
+    return vaddvq_f32(a);
+}
+
+inline Mask4 Less(Float4 a, Float4 b)
+{
+    return vcltq_f32(a, b);
+}
+
+inline Mask4 And(Mask4 a, Mask4 b)
+{
+    return vandq_u32(a, b);
+}
+
+inline Mask4 Or(Mask4 a, Mask4 b)
+{
+    return vorrq_u32(a, b);
+}
+
+inline Float4 Select(Mask4 mask, Float4 a, Float4 b)
+{
+    return vbslq_f32(mask, a, b);
+}
+
+inline int GetBits(Mask4 mask)
+{
+    const int32_t kShifts[kLanes] = {0, 1, 2, 3};
+    return vaddvq_u32(vshlq_u32(vshrq_n_u32(mask, 31), vld1q_s32(kShifts)));
+}
+#else
+struct Float4
+{
+    float V[kLanes];
+};
+
+struct Mask4
+{
+    bool V[kLanes];
+};
+
+template<typename F>
+inline Float4 Each(F function)
+{
+    Float4 result;
+    for (int i = 0; i < kLanes; i++)
+    {
+        result.V[i] = function(i);
+    }
+    return result;
+}
+
+inline Float4 Load(const float* data)
+{
+    return Each([&](int i) { return data[i]; });
+}
+
+inline void Store(float* data, Float4 value)
+{
+    std::copy(value.V, value.V + kLanes, data);
+}
+
+inline Float4 Set(float value)
+{
+    return Each([&](int i) { return value; });
+}
+
+inline Float4 Add(Float4 a, Float4 b)
+{
+    return Each([&](int i) { return a.V[i] + b.V[i]; });
+}
+
+inline Float4 Sub(Float4 a, Float4 b)
+{
+    return Each([&](int i) { return a.V[i] - b.V[i]; });
+}
+
+inline Float4 Mul(Float4 a, Float4 b)
+{
+    return Each([&](int i) { return a.V[i] * b.V[i]; });
+}
+
+inline Float4 Div(Float4 a, Float4 b)
+{
+    return Each([&](int i) { return a.V[i] / b.V[i]; });
+}
+
+inline Float4 Sqrt(Float4 a)
+{
+    return Each([&](int i) { return std::sqrt(a.V[i]); });
+}
+
+inline Float4 Min(Float4 a, Float4 b)
+{
+    return Each([&](int i) { return std::min(a.V[i], b.V[i]); });
+}
+
+inline Float4 Max(Float4 a, Float4 b)
+{
+    return Each([&](int i) { return std::max(a.V[i], b.V[i]); });
+}
+
+inline Float4 Abs(Float4 a)
+{
+    return Each([&](int i) { return std::abs(a.V[i]); });
+}
+
+inline float Sum(Float4 a)
+{
+    return (a.V[0] + a.V[2]) + (a.V[1] + a.V[3]);
+}
+
+inline Mask4 Less(Float4 a, Float4 b)
+{
+    return {a.V[0] < b.V[0], a.V[1] < b.V[1], a.V[2] < b.V[2], a.V[3] < b.V[3]};
+}
+
+inline Mask4 And(Mask4 a, Mask4 b)
+{
+    return {a.V[0] && b.V[0], a.V[1] && b.V[1], a.V[2] && b.V[2], a.V[3] && b.V[3]};
+}
+
+inline Mask4 Or(Mask4 a, Mask4 b)
+{
+    return {a.V[0] || b.V[0], a.V[1] || b.V[1], a.V[2] || b.V[2], a.V[3] || b.V[3]};
+}
+
+inline Float4 Select(Mask4 mask, Float4 a, Float4 b)
+{
+    return Each([&](int i) { return mask.V[i] ? a.V[i] : b.V[i]; });
+}
+
+inline int GetBits(Mask4 mask)
+{
+    return mask.V[0] | mask.V[1] << 1 | mask.V[2] << 2 | mask.V[3] << 3;
+}
+#endif
\ No newline at end of file
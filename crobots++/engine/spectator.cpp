@@ -0,0 +1,473 @@
+#include <SDL3/SDL.h>
+#include <box2d/box2d.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numbers>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+
+#include "network.hpp"
+#include "protocol.hpp"
+#include "spectator.hpp"
+#include "state.hpp"
+
+// deltas are only taken against snapshots this recent, which both ends are guaranteed to still have
+static constexpr uint32_t kHistory = 32;
+static constexpr int kPollTimeout = 2;
+// past this much unsent output new frames are skipped, and after this many skipped in a row the spectator goes
+static constexpr size_t kMaxPending = 256 * 1024;
+static constexpr uint32_t kMaxSkipped = 256;
+static constexpr float kQuantization = 65535.0f;
+
+static uint16_t QuantizePosition(float value, float width)
+{
+    return uint16_t(std::clamp(value / width, 0.0f, 1.0f) * kQuantization + 0.5f);
+}
+
+static float DequantizePosition(uint16_t value, float width)
+{
+    return value / kQuantization * width;
+}
+
+static uint16_t QuantizeHeading(b2Rot rotation)
+{
+    float turns = b2Rot_GetAngle(rotation) / (2.0f * std::numbers::pi_v<float>) + 0.5f;
+    return uint16_t(uint32_t(std::lround(turns * 65536.0f)));
+}
+
+static b2Rot DequantizeHeading(uint16_t value)
+{
+    return b2MakeRot((value / 65536.0f - 0.5f) * 2.0f * std::numbers::pi_v<float>);
+}
+
+// values wrap at 16 bits so headings crossing the seam stay small deltas too
+static void WriteDelta(Writer& writer, uint16_t value, uint16_t previous)
+{
+    int16_t delta = int16_t(uint16_t(value - previous));
+    writer.WriteVarint((uint32_t(delta) << 1) ^ uint32_t(delta >> 15));
+}
+
+static bool ReadDelta(Reader& reader, uint16_t& value, uint16_t previous)
+{
+    uint32_t zigzag;
+    if (!reader.ReadVarint(zigzag))
+    {
+        return false;
+    }
+    int32_t delta = int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+    value = uint16_t(previous + delta);
+    return true;
+}
+
+static bool Contains(const b2AABB& bounds, b2Vec2 position)
+{
+    return position.x >= bounds.lowerBound.x && position.y >= bounds.lowerBound.y &&
+        position.x <= bounds.upperBound.x && position.y <= bounds.upperBound.y;
+}
+
+Snapshot::Snapshot()
+    : Sequence{0}
+    , Ticks{0}
+    , Width{0.0f}
+    , Robots{}
+    , Projectiles{}
+{
+}
+
+SpectatorServer::SpectatorServer()
+    : Socket{}
+    , Spectators{}
+    , States{}
+    , Frame{}
+    , Payload{}
+    , Thread{nullptr}
+    , Running{false}
+{
+}
+
+bool SpectatorServer::Init(const std::string& address)
+{
+    if (!Socket.Listen(address))
+    {
+        SDL_Log("Failed to listen for spectators: %s", address.data());
+        return false;
+    }
+    Running.store(true, std::memory_order_relaxed);
+    Thread = SDL_CreateThread(Run, "spectators", this);
+    if (!Thread)
+    {
+        SDL_Log("Failed to create spectator thread: %s", SDL_GetError());
+        Socket.Close();
+        return false;
+    }
+    return true;
+}
+
+void SpectatorServer::Destroy()
+{
+    if (Thread)
+    {
+        Running.store(false, std::memory_order_relaxed);
+        SDL_WaitThread(Thread, nullptr);
+        Thread = nullptr;
+    }
+    Spectators.clear();
+    Socket.Close();
+}
+
+void SpectatorServer::Publish(const State& state)
+{
+    State& back = States.GetBack();
+    back.Robots = state.Robots;
+    back.Projectiles = state.Projectiles;
+    back.Ticks = state.Ticks;
+    back.Width = state.Width;
+    States.Publish();
+}
+
+int SpectatorServer::Run(void* data)
+{
+    SpectatorServer* server = static_cast<SpectatorServer*>(data);
+    std::vector<pollfd> handles;
+    while (server->Running.load(std::memory_order_relaxed))
+    {
+        handles.clear();
+        handles.push_back({server->Socket.GetHandle(), POLLIN, 0});
+        for (const std::unique_ptr<Spectator>& spectator : server->Spectators)
+        {
+            short events = POLLIN;
+            if (spectator->Socket.GetPending())
+            {
+                events |= POLLOUT;
+            }
+            handles.push_back({spectator->Socket.GetHandle(), events, 0});
+        }
+        // the timeout doubles as how often new states are picked up
+        if (poll(handles.data(), handles.size(), kPollTimeout) == -1 && errno != EINTR)
+        {
+            SDL_Log("Failed to poll: %s", std::strerror(errno));
+            return 1;
+        }
+        bool fresh = server->States.Update();
+        std::vector<std::unique_ptr<Spectator>>& spectators = server->Spectators;
+        int count = spectators.size();
+        for (int i = count - 1; i >= 0; i--)
+        {
+            Spectator& spectator = *spectators[i];
+            short events = handles[i + 1].revents;
+            if (((events & POLLOUT) && !spectator.Socket.Flush()) || ((events & ~POLLOUT) && !server->Receive(spectator)) ||
+                (fresh && !server->Send(spectator, server->States.GetFront())))
+            {
+                spectators.erase(spectators.begin() + i);
+            }
+        }
+        if (handles[0].revents & POLLIN)
+        {
+            std::unique_ptr<Spectator> spectator = std::make_unique<Spectator>();
+            if (server->Socket.Accept(spectator->Socket) && spectator->Socket.SetBlocking(false))
+            {
+                spectator->History.resize(kHistory);
+                spectator->Sequence = 0;
+                spectator->Acked = 0;
+                spectator->Interest = {};
+                spectator->Culling = false;
+                spectator->Skipped = 0;
+                // new spectators get the current tick straight away rather than at the next one
+                if (server->Send(*spectator, server->States.GetFront()))
+                {
+                    spectators.push_back(std::move(spectator));
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+bool SpectatorServer::Send(Spectator& spectator, const State& state)
+{
+    if (spectator.Socket.GetPending() > kMaxPending)
+    {
+        return ++spectator.Skipped < kMaxSkipped;
+    }
+    spectator.Skipped = 0;
+    uint32_t sequence = spectator.Sequence + 1;
+    const Snapshot* baseline = nullptr;
+    if (spectator.Acked && sequence - spectator.Acked < kHistory)
+    {
+        baseline = &spectator.History[spectator.Acked % kHistory];
+    }
+    Snapshot& snapshot = spectator.History[sequence % kHistory];
+    snapshot.Sequence = sequence;
+    snapshot.Ticks = state.Ticks;
+    snapshot.Width = std::max(state.Width, 1.0f);
+    {
+        Writer writer{Frame, MessageType::Snapshot};
+        writer.WriteVarint(sequence);
+        writer.WriteVarint(baseline ? baseline->Sequence : 0);
+        writer.Write(snapshot.Ticks);
+        writer.Write(snapshot.Width);
+        writer.WriteVarint(state.Robots.size());
+        snapshot.Robots.resize(state.Robots.size());
+        for (int i = 0; i < state.Robots.size(); i++)
+        {
+            const RobotState& robot = state.Robots[i];
+            SnapshotRobot previous{};
+            if (baseline && i < baseline->Robots.size())
+            {
+                previous = baseline->Robots[i];
+            }
+            SnapshotRobot& current = snapshot.Robots[i];
+            current = previous;
+            current.Visible = !spectator.Culling || Contains(spectator.Interest, robot.Position);
+            if (current.Visible)
+            {
+                current.X = QuantizePosition(robot.Position.x, snapshot.Width);
+                current.Y = QuantizePosition(robot.Position.y, snapshot.Width);
+                current.Heading = QuantizeHeading(robot.Rotation);
+            }
+            bool changed = !baseline || current.X != previous.X || current.Y != previous.Y || current.Heading != previous.Heading;
+            writer.Write(uint8_t(current.Visible | (changed << 1)));
+            if (changed)
+            {
+                WriteDelta(writer, current.X, previous.X);
+                WriteDelta(writer, current.Y, previous.Y);
+                WriteDelta(writer, current.Heading, previous.Heading);
+            }
+        }
+        snapshot.Projectiles.clear();
+        for (const ProjectileState& projectile : state.Projectiles)
+        {
+            if (!spectator.Culling || Contains(spectator.Interest, projectile.Position))
+            {
+                SnapshotProjectile& current = snapshot.Projectiles.emplace_back();
+                current.X = QuantizePosition(projectile.Position.x, snapshot.Width);
+                current.Y = QuantizePosition(projectile.Position.y, snapshot.Width);
+            }
+        }
+        // projectiles have no identity so they're paired with the baseline's by index
+        writer.WriteVarint(snapshot.Projectiles.size());
+        for (int i = 0; i < snapshot.Projectiles.size(); i++)
+        {
+            SnapshotProjectile previous{};
+            if (baseline && i < baseline->Projectiles.size())
+            {
+                previous = baseline->Projectiles[i];
+            }
+            WriteDelta(writer, snapshot.Projectiles[i].X, previous.X);
+            WriteDelta(writer, snapshot.Projectiles[i].Y, previous.Y);
+        }
+    }
+    spectator.Sequence = sequence;
+    return spectator.Socket.Post(Frame);
+}
+
+bool SpectatorServer::Receive(Spectator& spectator)
+{
+    if (!spectator.Socket.Receive())
+    {
+        return false;
+    }
+    MessageType type;
+    while (spectator.Socket.Pop(type, Payload))
+    {
+        Reader reader{Payload};
+        if (type == MessageType::Ack)
+        {
+            uint32_t sequence;
+            if (!reader.ReadVarint(sequence) || !reader.IsDone() || sequence > spectator.Sequence)
+            {
+                return false;
+            }
+            spectator.Acked = std::max(spectator.Acked, sequence);
+        }
+        else if (type == MessageType::Interest)
+        {
+            b2AABB& bounds = spectator.Interest;
+            if (!reader.Read(bounds.lowerBound.x) || !reader.Read(bounds.lowerBound.y) ||
+                !reader.Read(bounds.upperBound.x) || !reader.Read(bounds.upperBound.y) || !reader.IsDone())
+            {
+                return false;
+            }
+            spectator.Culling = true;
+        }
+        else
+        {
+            SDL_Log("Unexpected message from spectator: %d", int(type));
+            return false;
+        }
+    }
+    return true;
+}
+
+SpectatorClient::SpectatorClient()
+    : Socket{}
+    , History{}
+    , Frame{}
+    , Payload{}
+    , Sequence{0}
+{
+}
+
+bool SpectatorClient::Connect(const std::string& address)
+{
+    if (!Socket.Connect(address))
+    {
+        return false;
+    }
+    History.assign(kHistory, Snapshot{});
+    Sequence = 0;
+    return true;
+}
+
+void SpectatorClient::Close()
+{
+    Socket.Close();
+}
+
+bool SpectatorClient::Update(State& state, bool& updated, int timeout)
+{
+    updated = false;
+    pollfd handle{Socket.GetHandle(), POLLIN, 0};
+    if (poll(&handle, 1, timeout) == -1 && errno != EINTR)
+    {
+        SDL_Log("Failed to poll: %s", std::strerror(errno));
+        return false;
+    }
+    if (handle.revents && !Socket.Receive())
+    {
+        return false;
+    }
+    MessageType type;
+    while (Socket.Pop(type, Payload))
+    {
+        if (type != MessageType::Snapshot || !Decode(Payload))
+        {
+            SDL_Log("Failed to decode snapshot");
+            return false;
+        }
+        updated = true;
+    }
+    if (!updated)
+    {
+        return true;
+    }
+    // only the newest snapshot is shown, the ones before it just keep the baselines in step
+    const Snapshot& snapshot = History[Sequence % kHistory];
+    state.Robots.clear();
+    state.Projectiles.clear();
+    state.Segments.clear();
+    state.Polygons.clear();
+    for (const SnapshotRobot& robot : snapshot.Robots)
+    {
+        if (robot.Visible)
+        {
+            RobotState& robotState = state.Robots.emplace_back();
+            robotState.Position.x = DequantizePosition(robot.X, snapshot.Width);
+            robotState.Position.y = DequantizePosition(robot.Y, snapshot.Width);
+            robotState.Rotation = DequantizeHeading(robot.Heading);
+        }
+    }
+    for (const SnapshotProjectile& projectile : snapshot.Projectiles)
+    {
+        ProjectileState& projectileState = state.Projectiles.emplace_back();
+        projectileState.Position.x = DequantizePosition(projectile.X, snapshot.Width);
+        projectileState.Position.y = DequantizePosition(projectile.Y, snapshot.Width);
+    }
+    state.Ticks = snapshot.Ticks;
+    state.Width = snapshot.Width;
+    state.Profiling = false;
+    {
+        Writer writer{Frame, MessageType::Ack};
+        writer.WriteVarint(Sequence);
+    }
+    return Socket.Send(Frame);
+}
+
+bool SpectatorClient::SetInterest(const b2AABB& bounds)
+{
+    {
+        Writer writer{Frame, MessageType::Interest};
+        writer.Write(bounds.lowerBound.x);
+        writer.Write(bounds.lowerBound.y);
+        writer.Write(bounds.upperBound.x);
+        writer.Write(bounds.upperBound.y);
+    }
+    return Socket.Send(Frame);
+}
+
+bool SpectatorClient::Decode(const std::vector<uint8_t>& payload)
+{
+    Reader reader{payload};
+    uint32_t sequence;
+    uint32_t base;
+    if (!reader.ReadVarint(sequence) || !reader.ReadVarint(base) || sequence != Sequence + 1 || base >= sequence)
+    {
+        return false;
+    }
+    const Snapshot* baseline = nullptr;
+    if (base)
+    {
+        baseline = &History[base % kHistory];
+        if (baseline->Sequence != base)
+        {
+            return false;
+        }
+    }
+    Snapshot& snapshot = History[sequence % kHistory];
+    uint32_t robots;
+    if (!reader.Read(snapshot.Ticks) || !reader.Read(snapshot.Width) || !reader.ReadVarint(robots) || robots > payload.size())
+    {
+        return false;
+    }
+    snapshot.Robots.resize(robots);
+    for (int i = 0; i < robots; i++)
+    {
+        SnapshotRobot previous{};
+        if (baseline && i < baseline->Robots.size())
+        {
+            previous = baseline->Robots[i];
+        }
+        SnapshotRobot& current = snapshot.Robots[i];
+        current = previous;
+        uint8_t flags;
+        if (!reader.Read(flags))
+        {
+            return false;
+        }
+        current.Visible = flags & 1;
+        if ((flags & 2) && (!ReadDelta(reader, current.X, previous.X) || !ReadDelta(reader, current.Y, previous.Y) ||
+            !ReadDelta(reader, current.Heading, previous.Heading)))
+        {
+            return false;
+        }
+    }
+    uint32_t projectiles;
+    if (!reader.ReadVarint(projectiles) || projectiles > payload.size())
+    {
+        return false;
+    }
+    snapshot.Projectiles.resize(projectiles);
+    for (int i = 0; i < projectiles; i++)
+    {
+        SnapshotProjectile previous{};
+        if (baseline && i < baseline->Projectiles.size())
+        {
+            previous = baseline->Projectiles[i];
+        }
+        if (!ReadDelta(reader, snapshot.Projectiles[i].X, previous.X) || !ReadDelta(reader, snapshot.Projectiles[i].Y, previous.Y))
+        {
+            return false;
+        }
+    }
+    snapshot.Sequence = sequence;
+    Sequence = sequence;
+    return reader.IsDone();
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <box2d/box2d.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "network.hpp"
+#include "state.hpp"
+#include "triple_buffer.hpp"
+
+// positions are quantized to 16 bits across the arena and headings to 16 bits around the circle
+struct SnapshotRobot
+{
+    uint16_t X;
+    uint16_t Y;
+    uint16_t Heading;
+    // robots outside a spectator's interest keep their last sent values
+    bool Visible;
+};
+
+struct SnapshotProjectile
+{
+    uint16_t X;
+    uint16_t Y;
+};
+
+// a tick as a spectator sees it after decoding. both ends keep the recent ones as delta baselines
+struct Snapshot
+{
+    Snapshot();
+
+    uint32_t Sequence;
+    uint64_t Ticks;
+    float Width;
+    std::vector<SnapshotRobot> Robots;
+    std::vector<SnapshotProjectile> Projectiles;
+};
+
+// streams published states to any number of spectators from its own thread. every frame is a delta
+// against the newest snapshot the spectator acknowledged, or a full snapshot if there is none. sockets
+// don't block, so a slow spectator skips frames while its output backs up and is dropped if it stays backed up
+class SpectatorServer
+{
+public:
+    SpectatorServer();
+    bool Init(const std::string& address);
+    void Destroy();
+    // simulation thread only. copies what spectators need and never waits on them
+    void Publish(const State& state);
+
+private:
+    struct Spectator
+    {
+        Connection Socket;
+        std::vector<Snapshot> History;
+        uint32_t Sequence;
+        uint32_t Acked;
+        b2AABB Interest;
+        bool Culling;
+        // frames skipped in a row because output was backed up
+        uint32_t Skipped;
+    };
+
+    static int Run(void* data);
+    // false if the spectator should be dropped. a backed up spectator skips the frame
+    bool Send(Spectator& spectator, const State& state);
+    bool Receive(Spectator& spectator);
+
+    Listener Socket;
+    std::vector<std::unique_ptr<Spectator>> Spectators;
+    TripleBuffer<State> States;
+    std::vector<uint8_t> Frame;
+    std::vector<uint8_t> Payload;
+    SDL_Thread* Thread;
+    std::atomic<bool> Running;
+};
+
+class SpectatorClient
+{
+public:
+    SpectatorClient();
+    bool Connect(const std::string& address);
+    void Close();
+    // waits up to timeout milliseconds and decodes everything that arrived. the newest snapshot is written
+    // to state and acknowledged. false once the host is gone or sends something undecodable
+    bool Update(State& state, bool& updated, int timeout);
+    // asks the host to leave out robots and projectiles outside of bounds
+    bool SetInterest(const b2AABB& bounds);
+
+private:
+    bool Decode(const std::vector<uint8_t>& payload);
+
+    Connection Socket;
+    std::vector<Snapshot> History;
+    std::vector<uint8_t> Frame;
+    std::vector<uint8_t> Payload;
+    uint32_t Sequence;
+};
\ No newline at end of file
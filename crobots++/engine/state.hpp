@@ -0,0 +1,60 @@
+#pragma once
+
+#include <box2d/box2d.h>
+
+#include <cstdint>
+#include <vector>
+
+struct RobotState
+{
+    b2Vec2 Position;
+    b2Rot Rotation;
+};
+
+struct ProjectileState
+{
+    b2Vec2 Position;
+};
+
+struct DebugSegment
+{
+    b2Vec2 P1;
+    b2Vec2 P2;
+    b2HexColor Color;
+};
+
+struct DebugPolygon
+{
+    b2Transform Transform;
+    b2Vec2 Vertices[B2_MAX_POLYGON_VERTICES];
+    int Count;
+    b2HexColor Color;
+};
+
+// only filled in while the engine is profiling
+struct TickProfile
+{
+    TickProfile();
+
+    // nanoseconds spent in the last tick
+    uint64_t Time;
+    b2Profile Physics;
+    b2Counters Counters;
+    // nanoseconds each robot spent in its last update
+    std::vector<uint64_t> Updates;
+};
+
+// immutable copy of everything needed to draw a tick. owned by the simulation thread until published
+struct State
+{
+    State();
+
+    std::vector<RobotState> Robots;
+    std::vector<ProjectileState> Projectiles;
+    std::vector<DebugSegment> Segments;
+    std::vector<DebugPolygon> Polygons;
+    TickProfile Profile;
+    uint64_t Ticks;
+    float Width;
+    bool Profiling;
+};
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// single producer, single consumer. the producer writes into the back buffer and publishes it,
+// the consumer picks up the newest published buffer. neither side ever blocks the other
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : Buffers{}
+        , Middle{1}
+        , Back{0}
+        , Front{2}
+    {
+    }
+
+    TripleBuffer(const TripleBuffer& other) = delete;
+    TripleBuffer& operator=(const TripleBuffer& other) = delete;
+
+    // producer only. contents are whatever was published three swaps ago
+    T& GetBack()
+    {
+        return Buffers[Back];
+    }
+
+    // producer only
+    void Publish()
+    {
+        Back = Middle.exchange(Back | kFresh, std::memory_order_acq_rel) & kIndex;
+    }
+
+    // consumer only. returns true if a newer buffer was picked up
+    bool Update()
+    {
+        if (!(Middle.load(std::memory_order_relaxed) & kFresh))
+        {
+            return false;
+        }
+        Front = Middle.exchange(Front, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+
+    // consumer only
+    const T& GetFront() const
+    {
+        return Buffers[Front];
+    }
+
+private:
+    static constexpr uint8_t kIndex = 3;
+    static constexpr uint8_t kFresh = 4;
+
+    T Buffers[3];
+    alignas(64) std::atomic<uint8_t> Middle;
+    alignas(64) uint8_t Back;
+    alignas(64) uint8_t Front;
+};
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include <box2d/box2d.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "state.hpp"
+#include "wall.hpp"
+
+// fraction of an arena left empty between neighbouring tiles
+static constexpr float kGap = 0.1f;
+
+Wall::Wall()
+    : Matches{0}
+    , Columns{1}
+    , Rows{1}
+    , Width{0.0f}
+    , Tile{0.0f}
+{
+}
+
+void Wall::Init(int matches, float width)
+{
+    Matches = std::max(matches, 1);
+    Columns = int(std::ceil(std::sqrt(float(Matches))));
+    Rows = (Matches + Columns - 1) / Columns;
+    Width = width;
+    Tile = width * (1.0f + kGap);
+}
+
+void Wall::Build(const std::vector<State>& states, State& wall) const
+{
+    wall.Robots.clear();
+    wall.Projectiles.clear();
+    wall.Segments.clear();
+    wall.Polygons.clear();
+    wall.Profile.Time = 0;
+    wall.Profile.Updates.clear();
+    wall.Ticks = 0;
+    wall.Profiling = false;
+    for (int i = 0; i < states.size(); i++)
+    {
+        const State& state = states[i];
+        b2Vec2 offset = GetOffset(i);
+        for (const RobotState& robot : state.Robots)
+        {
+            RobotState& robotState = wall.Robots.emplace_back(robot);
+            robotState.Position = b2Add(robot.Position, offset);
+        }
+        for (const ProjectileState& projectile : state.Projectiles)
+        {
+            wall.Projectiles.emplace_back().Position = b2Add(projectile.Position, offset);
+        }
+        for (const DebugSegment& segment : state.Segments)
+        {
+            DebugSegment& debugSegment = wall.Segments.emplace_back(segment);
+            debugSegment.P1 = b2Add(segment.P1, offset);
+            debugSegment.P2 = b2Add(segment.P2, offset);
+        }
+        for (const DebugPolygon& polygon : state.Polygons)
+        {
+            DebugPolygon& debugPolygon = wall.Polygons.emplace_back(polygon);
+            debugPolygon.Transform.p = b2Add(polygon.Transform.p, offset);
+        }
+        // outline every arena so tiles read as separate matches even without debug drawing
+        const b2Vec2 kCorners[4] = {{0.0f, 0.0f}, {Width, 0.0f}, {Width, Width}, {0.0f, Width}};
+        for (int j = 0; j < 4; j++)
+        {
+            DebugSegment& segment = wall.Segments.emplace_back();
+            segment.P1 = b2Add(kCorners[j], offset);
+            segment.P2 = b2Add(kCorners[(j + 1) % 4], offset);
+            segment.Color = b2_colorGray;
+        }
+        // times add up across the wall, per slot for robots. box2d's own numbers are from the last profiled match
+        if (state.Profiling)
+        {
+            wall.Profiling = true;
+            wall.Profile.Time += state.Profile.Time;
+            wall.Profile.Physics = state.Profile.Physics;
+            wall.Profile.Counters = state.Profile.Counters;
+            if (wall.Profile.Updates.size() < state.Profile.Updates.size())
+            {
+                wall.Profile.Updates.resize(state.Profile.Updates.size(), 0);
+            }
+            for (int j = 0; j < state.Profile.Updates.size(); j++)
+            {
+                wall.Profile.Updates[j] += state.Profile.Updates[j];
+            }
+        }
+        wall.Ticks = std::max(wall.Ticks, state.Ticks);
+    }
+    wall.Width = std::max(GetWidth(), GetHeight());
+}
+
+b2Vec2 Wall::GetOffset(int match) const
+{
+    return {(match % Columns) * Tile, (match / Columns) * Tile};
+}
+
+float Wall::GetWidth() const
+{
+    return Columns * Tile - Width * kGap;
+}
+
+float Wall::GetHeight() const
+{
+    return Rows * Tile - Width * kGap;
+}
\ No newline at end of file
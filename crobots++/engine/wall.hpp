@@ -0,0 +1,29 @@
+#pragma once
+
+#include <box2d/box2d.h>
+
+#include <vector>
+
+#include "state.hpp"
+
+// lays many matches out in a grid and merges their states into one, so the renderer draws the whole wall
+// with the same single upload and handful of draws it spends on one match
+class Wall
+{
+public:
+    Wall();
+    void Init(int matches, float width);
+    // every match is translated into its tile as it's copied, so the offset travels in the instance data
+    void Build(const std::vector<State>& states, State& wall) const;
+    b2Vec2 GetOffset(int match) const;
+    // of the whole grid
+    float GetWidth() const;
+    float GetHeight() const;
+
+private:
+    int Matches;
+    int Columns;
+    int Rows;
+    float Width;
+    float Tile;
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Vectorized training environments. Many matches are stepped together with one call, each with an agent in
+ * slot 0 whose speed comes from the caller and opponents loaded as robot modules. Observations, rewards and
+ * dones are written straight into arrays the caller owns, one row per environment
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CROBOTS_ENV_VERSION 1
+
+#if defined(_WIN32)
+#define CROBOTS_ENV_API __declspec(dllexport)
+#elif defined(__GNUC__) || defined(__clang__)
+#define CROBOTS_ENV_API __attribute__((visibility("default")))
+#else
+#define CROBOTS_ENV_API
+#endif
+
+/* floats per action: the speed to drive at, in meters/second */
+#define CROBOTS_ENV_ACTION_SIZE 1
+
+typedef struct crobots_env crobots_env;
+
+typedef struct crobots_env_config
+{
+    /* CROBOTS_ENV_VERSION */
+    uint32_t version;
+    /* environments */
+    int32_t count;
+    /* worker threads, 0 for one per core */
+    int32_t threads;
+    /* robots per match including the agent, 2 to 8 */
+    int32_t players;
+    /* robot modules drawn at random to fill the other slots every episode */
+    const char* const* opponents;
+    int32_t opponents_count;
+    /* where robot modules are loaded from, 0 for next to the executable */
+    const char* robot_directory;
+    /* seconds per tick */
+    float timestep;
+    /* seconds per episode, 0 to play until one robot is left */
+    float duration;
+    uint64_t seed;
+} crobots_env_config;
+
+/* fills in the defaults for everything but the opponents */
+CROBOTS_ENV_API void crobots_env_default_config(crobots_env_config* config);
+/* returns 0 on failure */
+CROBOTS_ENV_API crobots_env* crobots_env_create(const crobots_env_config* config);
+CROBOTS_ENV_API void crobots_env_destroy(crobots_env* env);
+CROBOTS_ENV_API int32_t crobots_env_get_count(const crobots_env* env);
+/* floats per observation */
+CROBOTS_ENV_API int32_t crobots_env_get_observation_size(const crobots_env* env);
+/*
+ * observations is count * observation size floats, rewards is count floats and dones is count bytes.
+ * they're written by every reset and step until bound again, so must outlive those calls
+ */
+CROBOTS_ENV_API void crobots_env_bind(crobots_env* env, float* observations, float* rewards, uint8_t* dones);
+/* starts a new episode everywhere and writes the first observations. returns 0 on failure */
+CROBOTS_ENV_API int crobots_env_reset(crobots_env* env);
+/*
+ * actions is count * CROBOTS_ENV_ACTION_SIZE floats. finished episodes are reset before returning, so a done
+ * row's reward belongs to the old episode and its observation to the new one. returns 0 on failure
+ */
+CROBOTS_ENV_API int crobots_env_step(crobots_env* env, const float* actions);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,491 @@
+#include <SDL3/SDL.h>
+#include <box2d/box2d.h>
+#include <crobots++/env.h>
+#include <crobots++/internal.hpp>
+#include <crobots++/robot.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "batch.hpp"
+#include "engine.hpp"
+#include "module.hpp"
+
+static constexpr const char* kAgent = "crobots_env_agent";
+static constexpr int kSelfSize = 7;
+static constexpr int kOpponentSize = 4;
+
+// stands in for the policy. the environment writes its speed straight into the context before every tick
+class Agent : public crobots::IRobot
+{
+public:
+    void Update(float deltaTime) override
+    {
+    }
+};
+
+static crobots::IRobot* NewAgent(const std::shared_ptr<crobots::RobotContext>& context)
+{
+    return crobots::IRobot::Create<Agent>(context);
+}
+
+class VectorEnvironment
+{
+public:
+    VectorEnvironment();
+    bool Init(const crobots_env_config& config);
+    void Destroy();
+    int GetCount() const;
+    int GetObservationSize() const;
+    void Bind(float* observations, float* rewards, uint8_t* dones);
+    bool Reset();
+    bool Step(const float* actions);
+
+private:
+    enum class Job
+    {
+        Reset,
+        Step,
+    };
+
+    // each worker owns a contiguous range of environments in its own batch world, one engine each, so a step
+    // moves the whole range in lockstep, never shares a cache line between threads and needs no locking past
+    // the start and end
+    struct Worker
+    {
+        VectorEnvironment* Owner;
+        std::unique_ptr<BatchWorld> World;
+        std::vector<Engine> Simulations;
+        SDL_Thread* Thread;
+        int Begin;
+        int End;
+        std::vector<std::string> Lineup;
+        std::vector<RobotResult> Results;
+        bool Failed;
+    };
+
+    static int Run(void* data);
+    void Run(Worker& worker);
+    bool Dispatch(Job job);
+    void Work(Worker& worker, Job job);
+    bool Start(Worker& worker, int environment);
+    void Observe(Worker& worker, int environment);
+
+    std::vector<Worker> Workers;
+    std::vector<std::string> Opponents;
+    // per environment so episodes don't depend on how environments are split across threads
+    std::vector<uint64_t> States;
+    std::vector<float> Damage;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    std::condition_variable Finished;
+    float* Observations;
+    float* Rewards;
+    uint8_t* Dones;
+    const float* Actions;
+    Job Current;
+    uint64_t Generation;
+    int Completed;
+    int Count;
+    int Players;
+    int ObservationSize;
+    bool Quit;
+};
+
+struct crobots_env
+{
+    VectorEnvironment Instance;
+};
+
+VectorEnvironment::VectorEnvironment()
+    : Workers{}
+    , Opponents{}
+    , States{}
+    , Damage{}
+    , Mutex{}
+    , Condition{}
+    , Finished{}
+    , Observations{nullptr}
+    , Rewards{nullptr}
+    , Dones{nullptr}
+    , Actions{nullptr}
+    , Current{Job::Reset}
+    , Generation{0}
+    , Completed{0}
+    , Count{0}
+    , Players{0}
+    , ObservationSize{0}
+    , Quit{false}
+{
+}
+
+bool VectorEnvironment::Init(const crobots_env_config& config)
+{
+    if (config.version != CROBOTS_ENV_VERSION)
+    {
+        SDL_Log("Unsupported environment version: %u", config.version);
+        return false;
+    }
+    if (config.count < 1)
+    {
+        SDL_Log("Must have at least one environment: %d", config.count);
+        return false;
+    }
+    if (config.players < 2 || config.players > kMaxRobots)
+    {
+        SDL_Log("Must have between 2 and 8 (inclusive) players: %d", config.players);
+        return false;
+    }
+    if (config.opponents_count < 1 || !config.opponents)
+    {
+        SDL_Log("Must have at least one opponent");
+        return false;
+    }
+    if (config.threads < 0)
+    {
+        SDL_Log("Thread count can't be negative: %d", config.threads);
+        return false;
+    }
+    for (int i = 0; i < config.opponents_count; i++)
+    {
+        Opponents.emplace_back(config.opponents[i]);
+    }
+    if (config.robot_directory)
+    {
+        ModuleRegistry::SetDirectory(config.robot_directory);
+    }
+    ModuleRegistry::Register(kAgent, NewAgent);
+    // load up front so a bad name fails here rather than in the middle of a step
+    for (const std::string& opponent : Opponents)
+    {
+        if (!ModuleRegistry::Load(opponent))
+        {
+            SDL_Log("Failed to load robot: %s", opponent.data());
+            return false;
+        }
+    }
+    Count = config.count;
+    Players = config.players;
+    ObservationSize = kSelfSize + kOpponentSize * (Players - 1);
+    States.resize(Count);
+    for (int i = 0; i < Count; i++)
+    {
+        States[i] = config.seed + (i + 1) * 0x9E3779B97F4A7C15ull;
+    }
+    Damage.assign(Count, 0.0f);
+    EngineParams params;
+    params.Timestep = config.timestep;
+    params.Duration = config.duration;
+    params.Physics = PhysicsType::Batch;
+    params.Robots.assign(Players, kAgent);
+    int threads = config.threads ? config.threads : SDL_GetNumLogicalCPUCores();
+    threads = std::clamp(threads, 1, Count);
+    // sized once so workers can keep pointers to their slot
+    Workers = std::vector<Worker>(threads);
+    for (int i = 0; i < threads; i++)
+    {
+        Worker& worker = Workers[i];
+        worker.Owner = this;
+        worker.Thread = nullptr;
+        worker.Begin = int(int64_t(Count) * i / threads);
+        worker.End = int(int64_t(Count) * (i + 1) / threads);
+        worker.Failed = false;
+        worker.World = std::make_unique<BatchWorld>(worker.End - worker.Begin);
+        worker.Simulations = std::vector<Engine>(worker.End - worker.Begin);
+        for (int j = 0; j < worker.Simulations.size(); j++)
+        {
+            Engine& simulation = worker.Simulations[j];
+            simulation.SetBatch(worker.World.get(), j);
+            if (!simulation.Init(params))
+            {
+                SDL_Log("Failed to initialize engine");
+                return false;
+            }
+        }
+    }
+    // the calling thread works the first range itself
+    for (int i = 1; i < threads; i++)
+    {
+        Workers[i].Thread = SDL_CreateThread(Run, "env", &Workers[i]);
+        if (!Workers[i].Thread)
+        {
+            SDL_Log("Failed to create thread: %s", SDL_GetError());
+            return false;
+        }
+    }
+    return true;
+}
+
+void VectorEnvironment::Destroy()
+{
+    {
+        std::lock_guard lock{Mutex};
+        Quit = true;
+    }
+    Condition.notify_all();
+    for (Worker& worker : Workers)
+    {
+        if (worker.Thread)
+        {
+            SDL_WaitThread(worker.Thread, nullptr);
+        }
+        for (Engine& simulation : worker.Simulations)
+        {
+            simulation.Destroy();
+        }
+    }
+    Workers.clear();
+}
+
+int VectorEnvironment::GetCount() const
+{
+    return Count;
+}
+
+int VectorEnvironment::GetObservationSize() const
+{
+    return ObservationSize;
+}
+
+void VectorEnvironment::Bind(float* observations, float* rewards, uint8_t* dones)
+{
+    Observations = observations;
+    Rewards = rewards;
+    Dones = dones;
+}
+
+bool VectorEnvironment::Reset()
+{
+    return Dispatch(Job::Reset);
+}
+
+bool VectorEnvironment::Step(const float* actions)
+{
+    Actions = actions;
+    bool result = Dispatch(Job::Step);
+    Actions = nullptr;
+    return result;
+}
+
+int VectorEnvironment::Run(void* data)
+{
+    Worker* worker = static_cast<Worker*>(data);
+    worker->Owner->Run(*worker);
+    return 0;
+}
+
+void VectorEnvironment::Run(Worker& worker)
+{
+    uint64_t generation = 0;
+    std::unique_lock lock{Mutex};
+    while (true)
+    {
+        Condition.wait(lock, [&]()
+        {
+            return Quit || Generation != generation;
+        });
+        if (Quit)
+        {
+            return;
+        }
+        generation = Generation;
+        Job job = Current;
+        lock.unlock();
+        Work(worker, job);
+        lock.lock();
+        if (++Completed == Workers.size())
+        {
+            Finished.notify_one();
+        }
+    }
+}
+
+bool VectorEnvironment::Dispatch(Job job)
+{
+    if (!Observations || !Rewards || !Dones)
+    {
+        SDL_Log("Environment buffers must be bound first");
+        return false;
+    }
+    {
+        std::lock_guard lock{Mutex};
+        Current = job;
+        Completed = 0;
+        Generation++;
+    }
+    Condition.notify_all();
+    Work(Workers.front(), job);
+    std::unique_lock lock{Mutex};
+    Completed++;
+    Finished.wait(lock, [this]()
+    {
+        return Completed == Workers.size();
+    });
+    bool result = true;
+    for (Worker& worker : Workers)
+    {
+        result &= !worker.Failed;
+        worker.Failed = false;
+    }
+    return result;
+}
+
+void VectorEnvironment::Work(Worker& worker, Job job)
+{
+    if (job == Job::Reset)
+    {
+        for (int i = worker.Begin; i < worker.End; i++)
+        {
+            Rewards[i] = 0.0f;
+            Dones[i] = false;
+            if (!Start(worker, i))
+            {
+                worker.Failed = true;
+                return;
+            }
+            Observe(worker, i);
+        }
+        return;
+    }
+    for (int i = worker.Begin; i < worker.End; i++)
+    {
+        if (worker.Simulations[i - worker.Begin].IsOver())
+        {
+            SDL_Log("Environment must be reset before stepping");
+            worker.Failed = true;
+            return;
+        }
+        worker.Simulations[i - worker.Begin].GetContext(0).Speed = Actions[i * CROBOTS_ENV_ACTION_SIZE];
+    }
+    TickBatch(*worker.World, worker.Simulations.data(), worker.Simulations.size());
+    for (int i = worker.Begin; i < worker.End; i++)
+    {
+        Engine& simulation = worker.Simulations[i - worker.Begin];
+        // shaped by damage taken every step, then scored by placement from 1 for a win to -1 for last
+        float damage = simulation.GetContext(0).Damage;
+        Rewards[i] = (Damage[i] - damage) / kMaxDamage;
+        Damage[i] = damage;
+        Dones[i] = simulation.IsOver();
+        if (!Dones[i])
+        {
+            Observe(worker, i);
+            continue;
+        }
+        simulation.GetResults(worker.Results);
+        Rewards[i] += 1.0f - 2.0f * (worker.Results[0].Placement - 1) / (Players - 1);
+        if (!Start(worker, i))
+        {
+            worker.Failed = true;
+            return;
+        }
+        Observe(worker, i);
+    }
+}
+
+bool VectorEnvironment::Start(Worker& worker, int environment)
+{
+    worker.Lineup.clear();
+    worker.Lineup.push_back(kAgent);
+    for (int i = 1; i < Players; i++)
+    {
+        worker.Lineup.push_back(Opponents[SDL_rand_r(&States[environment], Opponents.size())]);
+    }
+    Damage[environment] = 0.0f;
+    uint64_t seed = SDL_rand_bits_r(&States[environment]) | 1;
+    return worker.Simulations[environment - worker.Begin].Reset(seed, worker.Lineup);
+}
+
+void VectorEnvironment::Observe(Worker& worker, int environment)
+{
+    Engine& simulation = worker.Simulations[environment - worker.Begin];
+    float width = simulation.GetWidth();
+    float* observation = Observations + int64_t(environment) * ObservationSize;
+    const crobots::RobotContext& self = simulation.GetContext(0);
+    b2Vec2 velocity = simulation.GetVelocity(0);
+    b2Rot rotation = simulation.GetRotation(0);
+    *observation++ = self.X / width;
+    *observation++ = self.Y / width;
+    *observation++ = velocity.x;
+    *observation++ = velocity.y;
+    *observation++ = rotation.c;
+    *observation++ = rotation.s;
+    *observation++ = self.Damage / kMaxDamage;
+    for (int i = 1; i < Players; i++)
+    {
+        const crobots::RobotContext& other = simulation.GetContext(i);
+        *observation++ = (other.X - self.X) / width;
+        *observation++ = (other.Y - self.Y) / width;
+        *observation++ = other.Damage / kMaxDamage;
+        *observation++ = other.Damage < kMaxDamage;
+    }
+}
+
+void crobots_env_default_config(crobots_env_config* config)
+{
+    EngineParams params;
+    *config = crobots_env_config{};
+    config->version = CROBOTS_ENV_VERSION;
+    config->count = 1;
+    config->threads = 0;
+    config->players = 2;
+    config->timestep = params.Timestep;
+    config->duration = params.Duration;
+}
+
+crobots_env* crobots_env_create(const crobots_env_config* config)
+{
+    crobots_env* env = new (std::nothrow) crobots_env{};
+    if (!env)
+    {
+        SDL_Log("Failed to allocate environment");
+        return nullptr;
+    }
+    if (!env->Instance.Init(*config))
+    {
+        SDL_Log("Failed to initialize environment");
+        crobots_env_destroy(env);
+        return nullptr;
+    }
+    return env;
+}
+
+void crobots_env_destroy(crobots_env* env)
+{
+    if (!env)
+    {
+        return;
+    }
+    env->Instance.Destroy();
+    delete env;
+}
+
+int32_t crobots_env_get_count(const crobots_env* env)
+{
+    return env->Instance.GetCount();
+}
+
+int32_t crobots_env_get_observation_size(const crobots_env* env)
+{
+    return env->Instance.GetObservationSize();
+}
+
+void crobots_env_bind(crobots_env* env, float* observations, float* rewards, uint8_t* dones)
+{
+    env->Instance.Bind(observations, rewards, dones);
+}
+
+int crobots_env_reset(crobots_env* env)
+{
+    return env->Instance.Reset();
+}
+
+int crobots_env_step(crobots_env* env, const float* actions)
+{
+    return env->Instance.Step(actions);
+}
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "module.hpp"
+
+// exit code when both runs complete but don't agree, so scripts can tell it apart from a failure
+static constexpr int kDiverged = 2;
+
+// what one side of the comparison changes about how a match is simulated
+struct Configuration
+{
+    Configuration();
+
+    int SubSteps;
+    bool Settle;
+    // ticks between round trips through Checkpoint and Restore, 0 for never
+    uint64_t Restore;
+};
+
+Configuration::Configuration()
+    : SubSteps{EngineParams{}.SubSteps}
+    , Settle{EngineParams{}.Settle}
+    , Restore{0}
+{
+}
+
+struct BisectParams
+{
+    BisectParams();
+
+    EngineParams Engine;
+    // stop after this many ticks even if the match isn't over, 0 to play it out
+    uint64_t Ticks;
+    Configuration Configurations[2];
+};
+
+BisectParams::BisectParams()
+    : Engine{}
+    , Ticks{0}
+    , Configurations{}
+{
+}
+
+static bool GetParams(int argc, char** argv, BisectParams& params)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string outer = argv[i];
+        if (outer == "--robots")
+        {
+            for (; i + 1 < argc; i++)
+            {
+                std::string inner = argv[i + 1];
+                if (inner.starts_with("--"))
+                {
+                    break;
+                }
+                params.Engine.Robots.push_back(inner);
+            }
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            SDL_Log("Missing value: %s", outer.data());
+            return false;
+        }
+        std::string inner = argv[++i];
+        // configuration flags take one value for each side
+        bool pair = outer == "--substeps" || outer == "--settle" || outer == "--restore";
+        if (pair && i + 1 == argc)
+        {
+            SDL_Log("Missing second value: %s", outer.data());
+            return false;
+        }
+        std::string second = pair ? argv[++i] : "";
+        try
+        {
+            if (outer == "--timestep")
+            {
+                params.Engine.Timestep = std::stof(inner);
+            }
+            else if (outer == "--duration")
+            {
+                params.Engine.Duration = std::stof(inner);
+            }
+            else if (outer == "--seed")
+            {
+                params.Engine.Seed = std::stoull(inner);
+            }
+            else if (outer == "--ticks")
+            {
+                params.Ticks = std::stoull(inner);
+            }
+            else if (outer == "--substeps")
+            {
+                params.Configurations[0].SubSteps = std::stoi(inner);
+                params.Configurations[1].SubSteps = std::stoi(second);
+            }
+            else if (outer == "--settle")
+            {
+                params.Configurations[0].Settle = std::stoi(inner);
+                params.Configurations[1].Settle = std::stoi(second);
+            }
+            else if (outer == "--restore")
+            {
+                params.Configurations[0].Restore = std::stoull(inner);
+                params.Configurations[1].Restore = std::stoull(second);
+            }
+            else
+            {
+                SDL_Log("Unknown argument: %s", outer.data());
+                return false;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            SDL_Log("Failed to parse %s: %s", outer.data(), e.what());
+            return false;
+        }
+    }
+    if (params.Engine.Robots.size() < 2)
+    {
+        SDL_Log("Must have at least two robots");
+        return false;
+    }
+    if (!params.Ticks && params.Engine.Duration <= 0.0f)
+    {
+        SDL_Log("Must have a tick limit or a duration");
+        return false;
+    }
+    return true;
+}
+
+// plays ticks ticks, or until the match is over, recording the rolling hash after each one
+static bool Play(const BisectParams& params, const Configuration& configuration, uint64_t ticks, Engine& engine, std::vector<uint64_t>& hashes)
+{
+    EngineParams engineParams = params.Engine;
+    engineParams.SubSteps = configuration.SubSteps;
+    engineParams.Settle = configuration.Settle;
+    if (!engine.Init(engineParams))
+    {
+        SDL_Log("Failed to initialize engine");
+        return false;
+    }
+    engine.SetDebug(false);
+    engine.SetHashing(true);
+    hashes.clear();
+    std::vector<uint8_t> blob;
+    while (!engine.IsOver() && (!ticks || engine.GetTicks() < ticks))
+    {
+        engine.Tick();
+        if (configuration.Restore && engine.GetTicks() % configuration.Restore == 0)
+        {
+            engine.Checkpoint(blob);
+            if (!engine.Restore(blob))
+            {
+                SDL_Log("Failed to restore checkpoint");
+                engine.Destroy();
+                return false;
+            }
+        }
+        hashes.push_back(engine.GetHash());
+    }
+    return true;
+}
+
+static void PrintConfiguration(char side, const Configuration& configuration)
+{
+    std::printf("%c: substeps %d settle %d restore %llu\n", side, configuration.SubSteps, configuration.Settle,
+        (unsigned long long) configuration.Restore);
+}
+
+int main(int argc, char** argv)
+{
+    BisectParams params;
+    if (!GetParams(argc, argv, params))
+    {
+        return 1;
+    }
+    PrintConfiguration('a', params.Configurations[0]);
+    PrintConfiguration('b', params.Configurations[1]);
+    std::vector<uint64_t> hashes[2];
+    for (int i = 0; i < 2; i++)
+    {
+        Engine engine;
+        if (!Play(params, params.Configurations[i], params.Ticks, engine, hashes[i]))
+        {
+            return 1;
+        }
+        engine.Destroy();
+    }
+    uint64_t count = std::min(hashes[0].size(), hashes[1].size());
+    if (hashes[0] == hashes[1])
+    {
+        std::printf("identical over %llu ticks, hash %016llx\n", (unsigned long long) count,
+            (unsigned long long) (count ? hashes[0].back() : 0));
+        ModuleRegistry::Unload();
+        return 0;
+    }
+    // the hashes roll, so once they differ they stay different and the first difference can be bisected
+    uint64_t low = 0;
+    uint64_t high = count;
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        if (hashes[0][middle] == hashes[1][middle])
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    // hashes are recorded after each tick, so index n is tick n + 1
+    uint64_t tick = low + 1;
+    if (low == count)
+    {
+        std::printf("diverged after tick %llu: a ran %llu ticks, b ran %llu\n", (unsigned long long) count,
+            (unsigned long long) hashes[0].size(), (unsigned long long) hashes[1].size());
+        ModuleRegistry::Unload();
+        return kDiverged;
+    }
+    std::printf("diverged at tick %llu of %llu\n", (unsigned long long) tick, (unsigned long long) count);
+    // replay both sides up to the first bad tick and compare everything the hash covers
+    std::vector<StateField> fields[2];
+    for (int i = 0; i < 2; i++)
+    {
+        Engine engine;
+        std::vector<uint64_t> replayed;
+        if (!Play(params, params.Configurations[i], tick, engine, replayed))
+        {
+            return 1;
+        }
+        if (replayed.size() != tick || replayed.back() != hashes[i][tick - 1])
+        {
+            SDL_Log("Replay didn't reproduce the run, a robot may not be deterministic");
+        }
+        engine.GetFields(fields[i]);
+        engine.Destroy();
+    }
+    int printed = 0;
+    for (int i = 0; i < std::min(fields[0].size(), fields[1].size()); i++)
+    {
+        const StateField& a = fields[0][i];
+        const StateField& b = fields[1][i];
+        if (std::bit_cast<uint32_t>(a.Value) == std::bit_cast<uint32_t>(b.Value))
+        {
+            continue;
+        }
+        if (!printed)
+        {
+            std::printf("first differing field: %s\n", a.Name.data());
+        }
+        std::printf("%-36s a %.9g b %.9g\n", a.Name.data(), a.Value, b.Value);
+        printed++;
+    }
+    if (fields[0].size() != fields[1].size())
+    {
+        std::printf("a has %zu fields, b has %zu\n", fields[0].size(), fields[1].size());
+    }
+    ModuleRegistry::Unload();
+    return kDiverged;
+}
\ No newline at end of file
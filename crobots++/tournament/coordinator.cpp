@@ -0,0 +1,251 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+
+#include "coordinator.hpp"
+#include "engine.hpp"
+#include "match.hpp"
+#include "metrics.hpp"
+#include "network.hpp"
+#include "protocol.hpp"
+
+static constexpr int kNone = -1;
+// a shard that takes down this many workers is assumed to be what's killing them
+static constexpr int kMaxAttempts = 3;
+
+Coordinator::Coordinator()
+    : Socket{}
+    , Peers{}
+    , Shards{}
+    , Pending{}
+    , Frame{}
+    , OnDrop{}
+    , Completed{0}
+{
+}
+
+bool Coordinator::Listen(const std::string& address)
+{
+    if (!Socket.Listen(address))
+    {
+        SDL_Log("Failed to listen: %s", address.data());
+        return false;
+    }
+    SDL_Log("Waiting for workers on %s", address.data());
+    return true;
+}
+
+void Coordinator::Add(Connection&& connection)
+{
+    std::unique_ptr<Peer> peer = std::make_unique<Peer>();
+    peer->Socket = std::move(connection);
+    peer->Shard = kNone;
+    peer->Waiting = false;
+    Peers.push_back(std::move(peer));
+}
+
+void Coordinator::SetDropCallback(const DropCallback& callback)
+{
+    OnDrop = callback;
+}
+
+bool Coordinator::Serve(Peer& peer, const EngineParams& params, const std::vector<Match>& schedule)
+{
+    // shards still out on other workers may come back, so park the worker instead of releasing it
+    if (Pending.empty())
+    {
+        peer.Waiting = true;
+        return true;
+    }
+    // a stack so requeued shards go out first and don't become the stragglers
+    int index = Pending.back();
+    Pending.pop_back();
+    const Shard& shard = Shards[index];
+    ShardMessage message;
+    message.ID = index;
+    message.Params = params;
+    message.Matches.assign(schedule.begin() + shard.Begin, schedule.begin() + shard.End);
+    peer.Shard = index;
+    peer.Waiting = false;
+    peer.Results.assign(shard.End - shard.Begin, {});
+    peer.Received.assign(shard.End - shard.Begin, false);
+    Encode(Frame, message);
+    return peer.Socket.Send(Frame);
+}
+
+void Coordinator::Drop(Peer& peer)
+{
+    if (peer.Shard != kNone)
+    {
+        Metrics::Add(MetricCounter::Drops);
+        Shard& shard = Shards[peer.Shard];
+        if (++shard.Attempts < kMaxAttempts)
+        {
+            SDL_Log("Worker dropped, requeueing shard %d", peer.Shard);
+            Pending.push_back(peer.Shard);
+        }
+        else
+        {
+            SDL_Log("Worker dropped, skipping shard %d after %d attempts", peer.Shard, shard.Attempts);
+            Completed++;
+        }
+        peer.Shard = kNone;
+    }
+    if (OnDrop)
+    {
+        OnDrop(peer.Socket.GetHandle());
+    }
+    peer.Socket.Close();
+}
+
+bool Coordinator::Run(const EngineParams& params, const std::vector<Match>& schedule, int shardSize, const ResultCallback& callback)
+{
+    Shards.clear();
+    Pending.clear();
+    Completed = 0;
+    for (int i = 0; i < schedule.size(); i += shardSize)
+    {
+        Shards.emplace_back(i, std::min<int>(i + shardSize, schedule.size()), 0);
+    }
+    for (int i = Shards.size() - 1; i >= 0; i--)
+    {
+        Pending.push_back(i);
+    }
+    std::vector<pollfd> handles;
+    std::vector<uint8_t> payload;
+    ResultMessage result;
+    while (Completed < Shards.size())
+    {
+        if (Socket.GetHandle() == -1 && Peers.empty())
+        {
+            SDL_Log("No workers left");
+            return false;
+        }
+        // poll ignores negative handles, so a coordinator that isn't listening just has an inert first slot
+        handles.clear();
+        handles.push_back({Socket.GetHandle(), POLLIN, 0});
+        for (const std::unique_ptr<Peer>& peer : Peers)
+        {
+            handles.push_back({peer->Socket.GetHandle(), POLLIN, 0});
+        }
+        if (poll(handles.data(), handles.size(), -1) == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            SDL_Log("Failed to poll: %s", std::strerror(errno));
+            return false;
+        }
+        if (handles[0].revents & POLLIN)
+        {
+            Connection connection;
+            if (Socket.Accept(connection))
+            {
+                Add(std::move(connection));
+            }
+        }
+        // the drop callback may add peers, so only walk the ones that were polled
+        for (int i = 1; i < handles.size(); i++)
+        {
+            if (!handles[i].revents)
+            {
+                continue;
+            }
+            Peer& peer = *Peers[i - 1];
+            bool alive = peer.Socket.Receive();
+            MessageType type;
+            while (alive && peer.Socket.Pop(type, payload))
+            {
+                switch (type)
+                {
+                case MessageType::Request:
+                    alive = peer.Shard == kNone && Serve(peer, params, schedule);
+                    break;
+                case MessageType::Result:
+                    // results are indexed by the lineup when submitted, so one of the wrong size is a broken peer
+                    alive = Decode(payload, result) && peer.Shard != kNone && result.Shard == peer.Shard &&
+                        result.Match < peer.Results.size() &&
+                        result.Results.size() == schedule[Shards[peer.Shard].Begin + result.Match].Lineup.size();
+                    if (alive)
+                    {
+                        peer.Received[result.Match] = true;
+                        peer.Results[result.Match] = std::move(result.Results);
+                    }
+                    break;
+                case MessageType::Done:
+                {
+                    uint32_t index;
+                    alive = Decode(payload, index) && index == peer.Shard &&
+                        std::all_of(peer.Received.begin(), peer.Received.end(), [](bool received) { return received; });
+                    if (!alive)
+                    {
+                        break;
+                    }
+                    const Shard& shard = Shards[index];
+                    peer.Shard = kNone;
+                    Completed++;
+                    for (int j = shard.Begin; j < shard.End; j++)
+                    {
+                        callback(schedule[j], peer.Results[j - shard.Begin]);
+                    }
+                    break;
+                }
+                default:
+                    alive = false;
+                    break;
+                }
+            }
+            if (!alive)
+            {
+                Drop(peer);
+            }
+        }
+        std::erase_if(Peers, [](const std::unique_ptr<Peer>& peer)
+        {
+            return peer->Socket.GetHandle() == -1;
+        });
+        Metrics::Set(MetricGauge::Workers, Peers.size());
+        Metrics::Set(MetricGauge::BusyWorkers, std::count_if(Peers.begin(), Peers.end(), [](const std::unique_ptr<Peer>& peer)
+        {
+            return peer->Shard != kNone;
+        }));
+        // hand requeued shards to parked workers
+        for (int i = 0, count = Peers.size(); i < count; i++)
+        {
+            Peer& peer = *Peers[i];
+            if (peer.Waiting && !Pending.empty() && !Serve(peer, params, schedule))
+            {
+                Drop(peer);
+            }
+        }
+    }
+    Encode(Frame, MessageType::Quit);
+    for (const std::unique_ptr<Peer>& peer : Peers)
+    {
+        if (peer->Socket.GetHandle() != -1)
+        {
+            peer->Socket.Send(Frame);
+        }
+    }
+    return true;
+}
+
+void Coordinator::Close()
+{
+    // not Listener::Close, which would unlink the parent's socket path
+    for (const std::unique_ptr<Peer>& peer : Peers)
+    {
+        peer->Socket.Close();
+    }
+    Socket.Release();
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "match.hpp"
+#include "network.hpp"
+
+using ResultCallback = std::function<void(const Match& match, const std::vector<RobotResult>& results)>;
+// called with the handle of a worker's connection right before it is closed
+using DropCallback = std::function<void(int handle)>;
+
+// splits the schedule into shards and serves them to workers until every match is played. results of a shard
+// are only reported once all of it is done, so a worker that drops never causes a match to be counted twice
+class Coordinator
+{
+public:
+    Coordinator();
+    bool Listen(const std::string& address);
+    // adds an already connected worker, such as one end of a socket pair
+    void Add(Connection&& connection);
+    void SetDropCallback(const DropCallback& callback);
+    bool Run(const EngineParams& params, const std::vector<Match>& schedule, int shardSize, const ResultCallback& callback);
+    // closes every handle without notifying workers. used by forked children to let go of their copies
+    void Close();
+
+private:
+    struct Shard
+    {
+        int Begin;
+        int End;
+        int Attempts;
+    };
+
+    struct Peer
+    {
+        Connection Socket;
+        int Shard;
+        bool Waiting;
+        // results are held until the shard finishes so a drop can throw them away
+        std::vector<std::vector<RobotResult>> Results;
+        std::vector<bool> Received;
+    };
+
+    bool Serve(Peer& peer, const EngineParams& params, const std::vector<Match>& schedule);
+    void Drop(Peer& peer);
+
+    Listener Socket;
+    std::vector<std::unique_ptr<Peer>> Peers;
+    std::vector<Shard> Shards;
+    std::vector<int> Pending;
+    std::vector<uint8_t> Frame;
+    DropCallback OnDrop;
+    int Completed;
+};
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include <SDL3/SDL.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "evaluator.hpp"
+#include "match.hpp"
+
+Candidate::Candidate()
+    : Values{}
+    , Fitness{0.0}
+    , Matches{0}
+{
+}
+
+Evaluator::Evaluator()
+    : Workers{}
+    , Robots{}
+    , Mutex{}
+    , Condition{}
+    , Finished{}
+    , Candidates{nullptr}
+    , Names{nullptr}
+    , Matches{nullptr}
+    , Callback{nullptr}
+    , Next{0}
+    , Total{0}
+    , Completed{0}
+    , Quit{false}
+{
+}
+
+bool Evaluator::Init(const EngineParams& params, int threads)
+{
+    Robots = params.Robots;
+    EngineParams engineParams = params;
+    engineParams.Robots.resize(2, Robots.front());
+    // sized once so workers can keep pointers to their slot
+    Workers = std::vector<Worker>(threads);
+    for (Worker& worker : Workers)
+    {
+        worker.Owner = this;
+        worker.Thread = nullptr;
+        if (!worker.Simulation.Init(engineParams))
+        {
+            SDL_Log("Failed to initialize engine");
+            return false;
+        }
+    }
+    for (Worker& worker : Workers)
+    {
+        worker.Thread = SDL_CreateThread(Run, "evaluator", &worker);
+        if (!worker.Thread)
+        {
+            SDL_Log("Failed to create thread: %s", SDL_GetError());
+            return false;
+        }
+    }
+    return true;
+}
+
+void Evaluator::Destroy()
+{
+    {
+        std::lock_guard lock{Mutex};
+        Quit = true;
+    }
+    Condition.notify_all();
+    for (Worker& worker : Workers)
+    {
+        SDL_WaitThread(worker.Thread, nullptr);
+        worker.Simulation.Destroy();
+    }
+    Workers.clear();
+}
+
+void Evaluator::Evaluate(std::vector<Candidate>& candidates, const std::vector<std::string>& names, const std::vector<Match>& matches, const CandidateCallback& callback)
+{
+    if (candidates.empty() || matches.empty())
+    {
+        return;
+    }
+    std::unique_lock lock{Mutex};
+    for (Candidate& candidate : candidates)
+    {
+        candidate.Fitness = 0.0;
+        candidate.Matches = 0;
+    }
+    Candidates = &candidates;
+    Names = &names;
+    Matches = &matches;
+    Callback = &callback;
+    Next = 0;
+    Total = candidates.size() * matches.size();
+    Completed = 0;
+    Condition.notify_all();
+    Finished.wait(lock, [this]()
+    {
+        return Completed == Total;
+    });
+    Candidates = nullptr;
+    Names = nullptr;
+    Matches = nullptr;
+    Callback = nullptr;
+}
+
+int Evaluator::Run(void* data)
+{
+    Worker* worker = static_cast<Worker*>(data);
+    worker->Owner->Run(*worker);
+    return 0;
+}
+
+void Evaluator::Run(Worker& worker)
+{
+    std::unique_lock lock{Mutex};
+    while (true)
+    {
+        Condition.wait(lock, [this]()
+        {
+            return Quit || Next < Total;
+        });
+        if (Quit)
+        {
+            return;
+        }
+        // jobs are laid out candidate major so each candidate finishes as early as possible
+        uint64_t job = Next++;
+        int index = job / Matches->size();
+        Match match = (*Matches)[job % Matches->size()];
+        const Candidate& candidate = (*Candidates)[index];
+        for (int i = 0; i < Names->size(); i++)
+        {
+            match.Parameters.emplace_back(0, (*Names)[i], candidate.Values[i]);
+        }
+        lock.unlock();
+        double score = 0.0;
+        if (RunMatch(worker.Simulation, Robots, match, worker.Results))
+        {
+            score = double(match.Lineup.size() - worker.Results[0].Placement) / (match.Lineup.size() - 1);
+        }
+        else
+        {
+            SDL_Log("Failed to run match");
+        }
+        lock.lock();
+        Candidate& result = (*Candidates)[index];
+        result.Fitness += score;
+        result.Matches++;
+        if (result.Matches == Matches->size())
+        {
+            result.Fitness /= result.Matches;
+            (*Callback)(index, result);
+        }
+        if (++Completed == Total)
+        {
+            Finished.notify_one();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "match.hpp"
+
+struct Candidate
+{
+    Candidate();
+
+    std::vector<float> Values;
+    // mean score over every match, 1 for a win and 0 for last place
+    double Fitness;
+    int Matches;
+};
+
+using CandidateCallback = std::function<void(int index, const Candidate& candidate)>;
+
+// evaluates parameter candidates for the robot in slot 0 across a pool of threads that each own a warm engine
+class Evaluator
+{
+public:
+    Evaluator();
+    bool Init(const EngineParams& params, int threads);
+    void Destroy();
+    // blocks until every candidate has played every match. callbacks run one at a time as candidates finish
+    void Evaluate(std::vector<Candidate>& candidates, const std::vector<std::string>& names, const std::vector<Match>& matches, const CandidateCallback& callback);
+
+private:
+    struct Worker
+    {
+        Evaluator* Owner;
+        Engine Simulation;
+        SDL_Thread* Thread;
+        std::vector<RobotResult> Results;
+    };
+
+    static int Run(void* data);
+    void Run(Worker& worker);
+
+    std::vector<Worker> Workers;
+    std::vector<std::string> Robots;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    std::condition_variable Finished;
+    std::vector<Candidate>* Candidates;
+    const std::vector<std::string>* Names;
+    const std::vector<Match>* Matches;
+    const CandidateCallback* Callback;
+    uint64_t Next;
+    uint64_t Total;
+    uint64_t Completed;
+    bool Quit;
+};
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <SDL3/SDL.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "event.hpp"
+
+static constexpr char kMagic[8] = {'C', 'R', 'B', 'E', 'V', 'T', 0, 0};
+static constexpr uint32_t kVersion = 1;
+
+static bool GetParams(int argc, char** argv, std::filesystem::path& path, bool& csv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string outer = argv[i];
+        if (i + 1 == argc)
+        {
+            SDL_Log("Missing value: %s", outer.data());
+            return false;
+        }
+        std::string inner = argv[++i];
+        if (outer == "--events")
+        {
+            path = inner;
+        }
+        else if (outer == "--format")
+        {
+            if (inner == "text")
+            {
+                csv = false;
+            }
+            else if (inner == "csv")
+            {
+                csv = true;
+            }
+            else
+            {
+                SDL_Log("Unknown format: %s", inner.data());
+                return false;
+            }
+        }
+        else
+        {
+            SDL_Log("Unknown argument: %s", outer.data());
+            return false;
+        }
+    }
+    if (path.empty())
+    {
+        SDL_Log("Must have an event log to read");
+        return false;
+    }
+    return true;
+}
+
+static void PrintRobot(uint8_t robot, bool csv)
+{
+    if (robot != kNoRobot)
+    {
+        std::printf(csv ? "%d," : " %d", robot);
+    }
+    else
+    {
+        std::printf(csv ? "," : " -");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path path;
+    bool csv = false;
+    if (!GetParams(argc, argv, path, csv))
+    {
+        return 1;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (file.fail())
+    {
+        SDL_Log("Failed to open event log: %s", path.string().data());
+        return 1;
+    }
+    char magic[sizeof(kMagic)];
+    uint32_t version;
+    uint32_t size;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    // records are in the byte order of the machine that wrote them
+    if (file.fail() || std::memcmp(magic, kMagic, sizeof(kMagic)) || version != kVersion || size != sizeof(Event))
+    {
+        SDL_Log("Failed to parse event log: %s", path.string().data());
+        return 1;
+    }
+    if (csv)
+    {
+        std::printf("match,tick,type,robot,other,x,y,value,angle\n");
+    }
+    Event event;
+    while (file.read(reinterpret_cast<char*>(&event), sizeof(event)))
+    {
+        if (csv)
+        {
+            std::printf("%u,%llu,%s,", event.Match, (unsigned long long) event.Tick, EventLog::GetName(event.Type));
+            PrintRobot(event.Robot, csv);
+            PrintRobot(event.Other, csv);
+            std::printf("%g,%g,%g,%g\n", event.X, event.Y, event.Value, event.Angle);
+        }
+        else
+        {
+            std::printf("%8u %10llu %-12s", event.Match, (unsigned long long) event.Tick, EventLog::GetName(event.Type));
+            PrintRobot(event.Robot, csv);
+            PrintRobot(event.Other, csv);
+            std::printf(" (%.3f, %.3f) %.3f %.3f\n", event.X, event.Y, event.Value, event.Angle);
+        }
+    }
+    if (file.gcount())
+    {
+        SDL_Log("Truncated event: %s", path.string().data());
+    }
+    return 0;
+}
\ No newline at end of file
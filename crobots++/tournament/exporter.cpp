@@ -0,0 +1,122 @@
+#include <SDL3/SDL.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <poll.h>
+
+#include "exporter.hpp"
+#include "metrics.hpp"
+#include "network.hpp"
+
+// how often the thread checks whether to stop
+static constexpr int kPollTimeout = 100;
+// a client gets this long to send its request before it's dropped
+static constexpr int kRequestTimeout = 1000;
+static constexpr size_t kMaxRequest = 8192;
+
+MetricsExporter::MetricsExporter()
+    : Socket{}
+    , Thread{nullptr}
+    , Running{false}
+    , Text{}
+{
+}
+
+bool MetricsExporter::Init(const std::string& address)
+{
+    if (!Socket.Listen(address))
+    {
+        SDL_Log("Failed to listen for scrapes: %s", address.data());
+        return false;
+    }
+    Metrics::Enable();
+    Running = true;
+    Thread = SDL_CreateThread(Run, "metrics", this);
+    if (!Thread)
+    {
+        SDL_Log("Failed to create metrics thread: %s", SDL_GetError());
+        Socket.Close();
+        return false;
+    }
+    SDL_Log("Serving metrics on %s", address.data());
+    return true;
+}
+
+void MetricsExporter::Destroy()
+{
+    if (Thread)
+    {
+        Running = false;
+        SDL_WaitThread(Thread, nullptr);
+        Thread = nullptr;
+    }
+    Socket.Close();
+}
+
+int MetricsExporter::Run(void* data)
+{
+    MetricsExporter* exporter = static_cast<MetricsExporter*>(data);
+    while (exporter->Running.load(std::memory_order_relaxed))
+    {
+        pollfd handle{exporter->Socket.GetHandle(), POLLIN, 0};
+        int count = poll(&handle, 1, kPollTimeout);
+        if (count == -1 && errno != EINTR)
+        {
+            SDL_Log("Failed to poll: %s", std::strerror(errno));
+            return 1;
+        }
+        if (count <= 0)
+        {
+            continue;
+        }
+        Connection connection;
+        if (exporter->Socket.Accept(connection))
+        {
+            exporter->Serve(connection);
+        }
+    }
+    return 0;
+}
+
+void MetricsExporter::Serve(Connection& connection)
+{
+    // one request per connection, so read up to the end of the headers and ignore the rest
+    while (connection.GetInput().find("\r\n\r\n") == std::string_view::npos)
+    {
+        pollfd handle{connection.GetHandle(), POLLIN, 0};
+        if (connection.GetInput().size() > kMaxRequest || poll(&handle, 1, kRequestTimeout) <= 0 || !connection.Receive())
+        {
+            return;
+        }
+    }
+    std::string_view request = connection.GetInput();
+    request = request.substr(0, request.find("\r\n"));
+    const char* status = "200 OK";
+    if (!request.starts_with("GET "))
+    {
+        status = "405 Method Not Allowed";
+        Text.clear();
+    }
+    else if (!request.starts_with("GET / ") && !request.starts_with("GET /metrics "))
+    {
+        status = "404 Not Found";
+        Text.clear();
+    }
+    else
+    {
+        Metrics::Write(Text);
+    }
+    char header[256];
+    int size = std::snprintf(header, sizeof(header),
+        "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+        status, Text.size());
+    std::vector<uint8_t> response(header, header + size);
+    response.insert(response.end(), Text.begin(), Text.end());
+    connection.Send(response);
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <atomic>
+#include <string>
+
+#include "network.hpp"
+
+// serves Metrics over http on its own thread so a scrape never stalls matches. any GET of / or /metrics
+// gets the prometheus text, the address is either unix:<path> or <host>:<port> like everywhere else
+class MetricsExporter
+{
+public:
+    MetricsExporter();
+    bool Init(const std::string& address);
+    void Destroy();
+
+private:
+    static int Run(void* data);
+    void Serve(Connection& connection);
+
+    Listener Socket;
+    SDL_Thread* Thread;
+    std::atomic<bool> Running;
+    std::string Text;
+};
\ No newline at end of file
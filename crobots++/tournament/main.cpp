@@ -0,0 +1,522 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef CROBOTS_DISTRIBUTED
+#include "coordinator.hpp"
+#endif
+#include "arena.hpp"
+#include "batch.hpp"
+#include "commands.hpp"
+#include "engine.hpp"
+#include "event.hpp"
+#ifdef CROBOTS_DISTRIBUTED
+#include "exporter.hpp"
+#endif
+#include "match.hpp"
+#include "metrics.hpp"
+#include "module.hpp"
+#ifdef CROBOTS_DISTRIBUTED
+#include "pool.hpp"
+#endif
+#include "rating.hpp"
+
+struct TournamentParams
+{
+    TournamentParams();
+
+    EngineParams Engine;
+    uint64_t Matches;
+    int Players;
+    std::filesystem::path Load;
+    std::filesystem::path Checkpoint;
+    std::filesystem::path Events;
+    // directory to save every match's commands to
+    std::filesystem::path Record;
+    uint64_t Interval;
+    RatingSystem System;
+    std::string Listen;
+    // address to serve metrics on while the tournament runs
+    std::string Metrics;
+    int Shard;
+    int Processes;
+    // matches stepped in lockstep on the batch physics, 0 to play them one at a time
+    int Batch;
+};
+
+TournamentParams::TournamentParams()
+    : Engine{}
+    , Matches{100}
+    , Players{2}
+    , Load{}
+    , Checkpoint{}
+    , Events{}
+    , Record{}
+    , Interval{1000}
+    , System{RatingSystem::WengLin}
+    , Listen{}
+    , Metrics{}
+    , Shard{16}
+    , Processes{0}
+    , Batch{0}
+{
+}
+
+static bool GetParams(int argc, char** argv, TournamentParams& params)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string outer = argv[i];
+        if (outer == "--robots")
+        {
+            for (; i + 1 < argc; i++)
+            {
+                std::string inner = argv[i + 1];
+                if (inner.starts_with("--"))
+                {
+                    break;
+                }
+                params.Engine.Robots.push_back(inner);
+            }
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            SDL_Log("Missing value: %s", outer.data());
+            return false;
+        }
+        std::string inner = argv[++i];
+        try
+        {
+            if (outer == "--timestep")
+            {
+                params.Engine.Timestep = std::stof(inner);
+            }
+            else if (outer == "--duration")
+            {
+                params.Engine.Duration = std::stof(inner);
+            }
+            else if (outer == "--seed")
+            {
+                params.Engine.Seed = std::stoull(inner);
+            }
+            else if (outer == "--matches")
+            {
+                params.Matches = std::stoull(inner);
+            }
+            else if (outer == "--players")
+            {
+                params.Players = std::stoi(inner);
+            }
+            else if (outer == "--load")
+            {
+                params.Load = inner;
+            }
+            else if (outer == "--checkpoint")
+            {
+                params.Checkpoint = inner;
+            }
+            else if (outer == "--events")
+            {
+                params.Events = inner;
+            }
+            else if (outer == "--record")
+            {
+                params.Record = inner;
+            }
+            else if (outer == "--interval")
+            {
+                params.Interval = std::stoull(inner);
+            }
+            else if (outer == "--listen")
+            {
+                params.Listen = inner;
+            }
+            else if (outer == "--metrics")
+            {
+                params.Metrics = inner;
+            }
+            else if (outer == "--shard")
+            {
+                params.Shard = std::stoi(inner);
+            }
+            else if (outer == "--processes")
+            {
+                params.Processes = std::stoi(inner);
+            }
+            else if (outer == "--batch")
+            {
+                params.Batch = std::stoi(inner);
+            }
+            else if (outer == "--physics")
+            {
+                if (!GetPhysicsType(inner, params.Engine.Physics))
+                {
+                    SDL_Log("Unknown physics: %s", inner.data());
+                    return false;
+                }
+            }
+            else if (outer == "--arena")
+            {
+                params.Engine.Arena = std::stoi(inner);
+            }
+            else if (outer == "--system")
+            {
+                if (inner == "elo")
+                {
+                    params.System = RatingSystem::Elo;
+                }
+                else if (inner == "glicko")
+                {
+                    params.System = RatingSystem::Glicko;
+                }
+                else if (inner == "wenglin")
+                {
+                    params.System = RatingSystem::WengLin;
+                }
+                else
+                {
+                    SDL_Log("Unknown rating system: %s", inner.data());
+                    return false;
+                }
+            }
+            else
+            {
+                SDL_Log("Unknown argument: %s", outer.data());
+                return false;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            SDL_Log("Failed to parse %s: %s", outer.data(), e.what());
+            return false;
+        }
+    }
+    if (params.Engine.Robots.empty())
+    {
+        SDL_Log("Must have at least one robot");
+        return false;
+    }
+    if (params.Players < 2 || params.Players > 8)
+    {
+        SDL_Log("Must have between 2 and 8 (inclusive) players: %d", params.Players);
+        return false;
+    }
+    if (params.Shard < 1)
+    {
+        SDL_Log("Shard size must be positive: %d", params.Shard);
+        return false;
+    }
+    if (params.Processes < 0)
+    {
+        SDL_Log("Process count can't be negative: %d", params.Processes);
+        return false;
+    }
+    if (params.Batch < 0)
+    {
+        SDL_Log("Batch size can't be negative: %d", params.Batch);
+        return false;
+    }
+    if (params.Batch && (!params.Listen.empty() || params.Processes))
+    {
+        SDL_Log("Batched matches only run in process");
+        return false;
+    }
+    if (params.Batch && params.Engine.Physics != PhysicsType::Batch)
+    {
+        SDL_Log("Batched matches only run on the batch physics");
+        return false;
+    }
+    if (!params.Events.empty() && (!params.Listen.empty() || params.Processes))
+    {
+        SDL_Log("Event logs are only written for matches played in process");
+        return false;
+    }
+    if (!params.Record.empty() && (!params.Listen.empty() || params.Processes || params.Batch))
+    {
+        SDL_Log("Commands are only recorded for matches played in process one at a time");
+        return false;
+    }
+    if (params.Engine.Arena && (!params.Listen.empty() || params.Processes))
+    {
+        SDL_Log("Arenas are only used for matches played in process");
+        return false;
+    }
+#ifndef CROBOTS_DISTRIBUTED
+    if (!params.Listen.empty() || params.Processes)
+    {
+        SDL_Log("Distributed tournaments aren't supported on this platform");
+        return false;
+    }
+    if (!params.Metrics.empty())
+    {
+        SDL_Log("Metrics aren't supported on this platform");
+        return false;
+    }
+#endif
+    return true;
+}
+
+static void Submit(Ratings& ratings, const std::vector<int>& players, const Match& match, const std::vector<RobotResult>& results, uint64_t& queued)
+{
+    Metrics::Add(MetricCounter::Matches);
+    Metrics::Set(MetricGauge::Queued, --queued);
+    std::vector<Outcome> outcomes;
+    for (int i = 0; i < results.size(); i++)
+    {
+        Outcome& outcome = outcomes.emplace_back();
+        outcome.Player = players[match.Lineup[i]];
+        outcome.Placement = results[i].Placement;
+        outcome.DamageDealt = results[i].DamageDealt;
+        outcome.DamageTaken = results[i].Damage;
+        outcome.Time = results[i].Time;
+    }
+    ratings.Submit(outcomes.data(), outcomes.size());
+}
+
+// per match memory, summed over the tournament
+struct MemoryUsage
+{
+    MemoryUsage();
+    void Add(const ArenaStats& stats);
+    void Print() const;
+
+    uint64_t Matches;
+    uint64_t Allocations;
+    uint64_t MaxAllocations;
+    uint64_t Peak;
+    uint64_t MaxPeak;
+    uint64_t Reserved;
+};
+
+MemoryUsage::MemoryUsage()
+    : Matches{0}
+    , Allocations{0}
+    , MaxAllocations{0}
+    , Peak{0}
+    , MaxPeak{0}
+    , Reserved{0}
+{
+}
+
+void MemoryUsage::Add(const ArenaStats& stats)
+{
+    Matches++;
+    Allocations += stats.Allocations;
+    MaxAllocations = std::max(MaxAllocations, stats.Allocations);
+    Peak += stats.Peak;
+    MaxPeak = std::max(MaxPeak, stats.Peak);
+    Reserved = stats.Reserved;
+}
+
+void MemoryUsage::Print() const
+{
+    if (!Matches)
+    {
+        return;
+    }
+    std::printf("memory per match: %.0f allocations (max %llu), peak %.1f KB (max %.1f KB), %.1f KB reserved\n",
+        double(Allocations) / Matches, (unsigned long long) MaxAllocations, Peak / 1024.0 / Matches,
+        MaxPeak / 1024.0, Reserved / 1024.0);
+}
+
+static void PrintLeaderboard(const Ratings& ratings, RatingSystem system)
+{
+    std::printf("%-24s %10s %10s %10s %8s %8s %8s\n", "robot", "score", "elo", "glicko", "mu", "matches", "wins");
+    for (const Rating& rating : ratings.GetLeaderboard(system))
+    {
+        std::printf("%-24s %10.2f %10.2f %10.2f %8.2f %8llu %8llu\n", rating.Name.data(), rating.GetScore(system),
+            rating.Elo, rating.Glicko, rating.Mu, (unsigned long long) rating.Matches, (unsigned long long) rating.Wins);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    TournamentParams params;
+    if (!GetParams(argc, argv, params))
+    {
+        return 1;
+    }
+    if (params.Engine.Arena)
+    {
+        // before any world exists
+        Arena::Install();
+    }
+    MemoryUsage memory;
+#ifdef CROBOTS_DISTRIBUTED
+    MetricsExporter exporter;
+    if (!params.Metrics.empty() && !exporter.Init(params.Metrics))
+    {
+        SDL_Log("Failed to initialize metrics exporter");
+        return 1;
+    }
+#endif
+    Ratings ratings;
+    if (!params.Load.empty() && !ratings.Load(params.Load))
+    {
+        SDL_Log("Failed to load ratings");
+        return 1;
+    }
+    if (!params.Checkpoint.empty())
+    {
+        ratings.SetCheckpoint(params.Checkpoint, params.Interval);
+    }
+    const std::vector<std::string> robots = params.Engine.Robots;
+    std::vector<int> players;
+    for (const std::string& robot : robots)
+    {
+        players.push_back(ratings.GetPlayer(robot));
+    }
+    std::vector<Match> schedule = CreateSchedule(robots.size(), params.Players, params.Matches, params.Engine.Seed);
+    uint64_t queued = schedule.size();
+    Metrics::Set(MetricGauge::Queued, queued);
+#ifdef CROBOTS_DISTRIBUTED
+    auto submit = [&](const Match& match, const std::vector<RobotResult>& results)
+    {
+        Submit(ratings, players, match, results, queued);
+    };
+    if (!params.Listen.empty())
+    {
+        // workers play the matches, only the ratings live here
+        Coordinator coordinator;
+        if (!coordinator.Listen(params.Listen) || !coordinator.Run(params.Engine, schedule, params.Shard, submit))
+        {
+            SDL_Log("Failed to run coordinator");
+            return 1;
+        }
+    }
+    else if (params.Processes)
+    {
+        ProcessPool pool;
+        if (!pool.Init(params.Engine, params.Processes) || !pool.Run(schedule, submit))
+        {
+            SDL_Log("Failed to run process pool");
+            return 1;
+        }
+        pool.Destroy();
+        ModuleRegistry::Unload();
+    }
+    else
+#endif
+    if (params.Batch)
+    {
+        if (!params.Events.empty() && !EventLog::Open(params.Events))
+        {
+            SDL_Log("Failed to open event log");
+            return 1;
+        }
+        // matches in lockstep on one batch world, for when throughput matters more than fidelity
+        BatchWorld world{params.Batch};
+        std::vector<Engine> engines(params.Batch);
+        EngineParams engineParams = params.Engine;
+        engineParams.Robots.resize(params.Players, robots.front());
+        for (int i = 0; i < params.Batch; i++)
+        {
+            engines[i].SetBatch(&world, i);
+            if (!engines[i].Init(engineParams))
+            {
+                SDL_Log("Failed to initialize engine");
+                return 1;
+            }
+        }
+        std::vector<std::vector<RobotResult>> results;
+        Metrics::Set(MetricGauge::Workers, 1);
+        Metrics::Set(MetricGauge::BusyWorkers, 1);
+        for (uint64_t i = 0; i < schedule.size(); i += params.Batch)
+        {
+            int count = std::min<uint64_t>(params.Batch, schedule.size() - i);
+            uint64_t start = SDL_GetTicksNS();
+            if (!RunBatch(world, engines.data(), robots, &schedule[i], count, results))
+            {
+                SDL_Log("Failed to run batch");
+                return 1;
+            }
+            Metrics::Add(MetricCounter::Busy, SDL_GetTicksNS() - start);
+            for (int j = 0; j < count; j++)
+            {
+                ArenaStats stats;
+                if (engines[j].GetMemory(stats))
+                {
+                    memory.Add(stats);
+                }
+                Submit(ratings, players, schedule[i + j], results[j], queued);
+            }
+        }
+        for (Engine& engine : engines)
+        {
+            engine.Destroy();
+        }
+        EventLog::Close();
+        ModuleRegistry::Unload();
+    }
+    else
+    {
+        if (!params.Events.empty() && !EventLog::Open(params.Events))
+        {
+            SDL_Log("Failed to open event log");
+            return 1;
+        }
+        Engine engine;
+        CommandLog recording;
+        if (!params.Record.empty())
+        {
+            std::error_code error;
+            std::filesystem::create_directories(params.Record, error);
+            engine.SetRecording(&recording);
+            engine.SetHashing(true);
+        }
+        EngineParams engineParams = params.Engine;
+        engineParams.Robots.resize(params.Players, robots.front());
+        if (!engine.Init(engineParams))
+        {
+            SDL_Log("Failed to initialize engine");
+            return 1;
+        }
+        std::vector<RobotResult> results;
+        Metrics::Set(MetricGauge::Workers, 1);
+        Metrics::Set(MetricGauge::BusyWorkers, 1);
+        for (uint64_t i = 0; i < schedule.size(); i++)
+        {
+            const Match& match = schedule[i];
+            uint64_t start = SDL_GetTicksNS();
+            if (!RunMatch(engine, robots, match, results))
+            {
+                SDL_Log("Failed to run match");
+                return 1;
+            }
+            Metrics::Add(MetricCounter::Busy, SDL_GetTicksNS() - start);
+            ArenaStats stats;
+            if (engine.GetMemory(stats))
+            {
+                memory.Add(stats);
+                Metrics::Set(MetricGauge::ArenaPeak, stats.Peak);
+                Metrics::Set(MetricGauge::ArenaReserved, stats.Reserved);
+            }
+            if (!params.Record.empty() && !recording.Save(params.Record / ("match-" + std::to_string(i) + ".commands")))
+            {
+                SDL_Log("Failed to save command log");
+            }
+            Submit(ratings, players, match, results, queued);
+        }
+        engine.Destroy();
+        EventLog::Close();
+        ModuleRegistry::Unload();
+    }
+    if (!params.Checkpoint.empty() && !ratings.Save(params.Checkpoint))
+    {
+        SDL_Log("Failed to save ratings");
+    }
+    PrintLeaderboard(ratings, params.System);
+    memory.Print();
+#ifdef CROBOTS_DISTRIBUTED
+    exporter.Destroy();
+#endif
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "batch.hpp"
+#include "engine.hpp"
+#include "match.hpp"
+
+std::vector<Match> CreateSchedule(int robots, int players, uint64_t matches, uint64_t seed)
+{
+    std::vector<Match> schedule(matches);
+    uint64_t state = seed;
+    std::vector<int> pool(robots);
+    for (Match& match : schedule)
+    {
+        // draw without replacement while the pool lasts so a lineup only repeats robots when it has to
+        for (int i = 0; i < robots; i++)
+        {
+            pool[i] = i;
+        }
+        for (int i = 0; i < players; i++)
+        {
+            int remaining = robots - i % robots;
+            int j = SDL_rand_r(&state, remaining);
+            match.Lineup.push_back(pool[j]);
+            std::swap(pool[j], pool[remaining - 1]);
+        }
+        match.Seed = SDL_rand_bits_r(&state) | 1;
+    }
+    return schedule;
+}
+
+static bool Start(Engine& engine, const std::vector<std::string>& robots, const Match& match)
+{
+    std::vector<std::string> lineup;
+    for (int robot : match.Lineup)
+    {
+        lineup.push_back(robots[robot]);
+    }
+    if (!engine.Reset(match.Seed, lineup))
+    {
+        SDL_Log("Failed to reset engine");
+        return false;
+    }
+    for (const ParameterValue& parameter : match.Parameters)
+    {
+        engine.SetParameter(parameter.Slot, parameter.Name, parameter.Value);
+    }
+    return true;
+}
+
+bool RunMatch(Engine& engine, const std::vector<std::string>& robots, const Match& match, std::vector<RobotResult>& results)
+{
+    if (!Start(engine, robots, match))
+    {
+        return false;
+    }
+    while (!engine.IsOver())
+    {
+        engine.Tick();
+    }
+    engine.GetResults(results);
+    return true;
+}
+
+bool RunBatch(BatchWorld& world, Engine* engines, const std::vector<std::string>& robots, const Match* matches, int count,
+    std::vector<std::vector<RobotResult>>& results)
+{
+    SDL_assert(count <= world.GetMatches());
+    for (int i = 0; i < count; i++)
+    {
+        if (!Start(engines[i], robots, matches[i]))
+        {
+            return false;
+        }
+    }
+    while (std::any_of(engines, engines + count, [](const Engine& engine) { return !engine.IsOver(); }))
+    {
+        TickBatch(world, engines, count);
+    }
+    results.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        engines[i].GetResults(results[i]);
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BatchWorld;
+class Engine;
+struct RobotResult;
+
+struct ParameterValue
+{
+    // index into the lineup
+    int Slot;
+    std::string Name;
+    float Value;
+};
+
+struct Match
+{
+    uint64_t Seed;
+    // indices into the tournament's robot list
+    std::vector<int> Lineup;
+    std::vector<ParameterValue> Parameters;
+};
+
+std::vector<Match> CreateSchedule(int robots, int players, uint64_t matches, uint64_t seed);
+bool RunMatch(Engine& engine, const std::vector<std::string>& robots, const Match& match, std::vector<RobotResult>& results);
+// plays up to the world's match count at once, one engine each in world. results line up with matches
+bool RunBatch(BatchWorld& world, Engine* engines, const std::vector<std::string>& robots, const Match* matches, int count,
+    std::vector<std::vector<RobotResult>>& results);
\ No newline at end of file
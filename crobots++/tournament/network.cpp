@@ -0,0 +1,431 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "network.hpp"
+#include "protocol.hpp"
+
+static constexpr const char* kUnixPrefix = "unix:";
+static constexpr int kBacklog = 64;
+static constexpr int kReadSize = 64 * 1024;
+
+#ifdef MSG_NOSIGNAL
+static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+static constexpr int kSendFlags = 0;
+#endif
+
+static bool GetUnixAddress(const std::string& path, sockaddr_un& address)
+{
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        SDL_Log("Socket path is too long: %s", path.data());
+        return false;
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.data(), path.size());
+    return true;
+}
+
+static addrinfo* GetTCPAddress(const std::string& address, bool passive)
+{
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos)
+    {
+        SDL_Log("Address is missing a port: %s", address.data());
+        return nullptr;
+    }
+    std::string host = address.substr(0, colon);
+    std::string port = address.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo* info;
+    int error = getaddrinfo(host.empty() ? nullptr : host.data(), port.data(), &hints, &info);
+    if (error)
+    {
+        SDL_Log("Failed to resolve %s: %s", address.data(), gai_strerror(error));
+        return nullptr;
+    }
+    return info;
+}
+
+static void SetOptions(int handle, bool tcp)
+{
+    int enable = 1;
+    // results are small and latency bound, so don't let nagle hold them back
+    if (tcp)
+    {
+        setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+#ifdef SO_NOSIGPIPE
+    setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+    fcntl(handle, F_SETFD, FD_CLOEXEC);
+}
+
+Connection::Connection()
+    : Handle{-1}
+    , Input{}
+    , Offset{0}
+    , Output{}
+{
+}
+
+Connection::Connection(Connection&& other)
+    : Handle{std::exchange(other.Handle, -1)}
+    , Input{std::move(other.Input)}
+    , Offset{std::exchange(other.Offset, 0)}
+    , Output{std::move(other.Output)}
+{
+}
+
+Connection& Connection::operator=(Connection&& other)
+{
+    if (this != &other)
+    {
+        Close();
+        Handle = std::exchange(other.Handle, -1);
+        Input = std::move(other.Input);
+        Offset = std::exchange(other.Offset, 0);
+        Output = std::move(other.Output);
+    }
+    return *this;
+}
+
+Connection::~Connection()
+{
+    Close();
+}
+
+bool Connection::Connect(const std::string& address)
+{
+    Close();
+    if (address.starts_with(kUnixPrefix))
+    {
+        sockaddr_un unixAddress;
+        if (!GetUnixAddress(address.substr(std::strlen(kUnixPrefix)), unixAddress))
+        {
+            return false;
+        }
+        Handle = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (Handle == -1 || connect(Handle, reinterpret_cast<sockaddr*>(&unixAddress), sizeof(unixAddress)))
+        {
+            SDL_Log("Failed to connect to %s: %s", address.data(), std::strerror(errno));
+            Close();
+            return false;
+        }
+        SetOptions(Handle, false);
+        return true;
+    }
+    addrinfo* info = GetTCPAddress(address, false);
+    if (!info)
+    {
+        return false;
+    }
+    for (addrinfo* i = info; i; i = i->ai_next)
+    {
+        Handle = socket(i->ai_family, i->ai_socktype, i->ai_protocol);
+        if (Handle != -1 && !connect(Handle, i->ai_addr, i->ai_addrlen))
+        {
+            break;
+        }
+        Close();
+    }
+    freeaddrinfo(info);
+    if (Handle == -1)
+    {
+        SDL_Log("Failed to connect to %s: %s", address.data(), std::strerror(errno));
+        return false;
+    }
+    SetOptions(Handle, true);
+    return true;
+}
+
+bool Connection::Pair(Connection& a, Connection& b)
+{
+    int handles[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, handles))
+    {
+        SDL_Log("Failed to create socket pair: %s", std::strerror(errno));
+        return false;
+    }
+    a.Close();
+    b.Close();
+    a.Handle = handles[0];
+    b.Handle = handles[1];
+    SetOptions(a.Handle, false);
+    SetOptions(b.Handle, false);
+    return true;
+}
+
+void Connection::Close()
+{
+    if (Handle != -1)
+    {
+        close(Handle);
+        Handle = -1;
+    }
+    Input.clear();
+    Offset = 0;
+    Output.clear();
+}
+
+bool Connection::Send(const std::vector<uint8_t>& frame)
+{
+    size_t sent = 0;
+    while (sent < frame.size())
+    {
+        ssize_t count = send(Handle, frame.data() + sent, frame.size() - sent, kSendFlags);
+        if (count == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        sent += count;
+    }
+    return true;
+}
+
+bool Connection::Post(const std::vector<uint8_t>& frame)
+{
+    Output.insert(Output.end(), frame.begin(), frame.end());
+    return Flush();
+}
+
+bool Connection::Flush()
+{
+    size_t sent = 0;
+    while (sent < Output.size())
+    {
+        ssize_t count = send(Handle, Output.data() + sent, Output.size() - sent, kSendFlags);
+        if (count == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        sent += count;
+    }
+    Output.erase(Output.begin(), Output.begin() + sent);
+    return true;
+}
+
+size_t Connection::GetPending() const
+{
+    return Output.size();
+}
+
+bool Connection::SetBlocking(bool blocking)
+{
+    int flags = fcntl(Handle, F_GETFL);
+    if (flags == -1 || fcntl(Handle, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK) == -1)
+    {
+        SDL_Log("Failed to set blocking mode: %s", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool Connection::Receive()
+{
+    // compact once the consumed prefix dominates so the buffer doesn't grow forever
+    if (Offset && Offset * 2 >= Input.size())
+    {
+        Input.erase(Input.begin(), Input.begin() + Offset);
+        Offset = 0;
+    }
+    size_t size = Input.size();
+    Input.resize(size + kReadSize);
+    ssize_t count;
+    do
+    {
+        count = recv(Handle, Input.data() + size, kReadSize, 0);
+    }
+    while (count == -1 && errno == EINTR);
+    // a non-blocking socket with nothing to read yet still has its peer
+    bool waiting = count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    Input.resize(size + std::max<ssize_t>(count, 0));
+    return count > 0 || waiting;
+}
+
+bool Connection::Pop(MessageType& type, std::vector<uint8_t>& payload)
+{
+    size_t available = Input.size() - Offset;
+    if (available < kFrameHeader)
+    {
+        return false;
+    }
+    const uint8_t* header = Input.data() + Offset;
+    uint32_t size = header[0] | header[1] << 8 | header[2] << 16 | uint32_t(header[3]) << 24;
+    if (size > kMaxFrame)
+    {
+        // garbage on the wire, so drop the peer. the next receive fails
+        SDL_Log("Frame is too large: %u", size);
+        Close();
+        return false;
+    }
+    if (available < kFrameHeader + size)
+    {
+        return false;
+    }
+    type = MessageType(header[4]);
+    payload.assign(header + kFrameHeader, header + kFrameHeader + size);
+    Offset += kFrameHeader + size;
+    return true;
+}
+
+bool Connection::Wait(MessageType& type, std::vector<uint8_t>& payload)
+{
+    while (!Pop(type, payload))
+    {
+        if (!Receive())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view Connection::GetInput() const
+{
+    return {reinterpret_cast<const char*>(Input.data()) + Offset, Input.size() - Offset};
+}
+
+int Connection::GetHandle() const
+{
+    return Handle;
+}
+
+Listener::Listener()
+    : Handle{-1}
+    , Path{}
+{
+}
+
+Listener::~Listener()
+{
+    Close();
+}
+
+bool Listener::Listen(const std::string& address)
+{
+    Close();
+    if (address.starts_with(kUnixPrefix))
+    {
+        std::string path = address.substr(std::strlen(kUnixPrefix));
+        sockaddr_un unixAddress;
+        if (!GetUnixAddress(path, unixAddress))
+        {
+            return false;
+        }
+        // a stale socket from a previous run would make bind fail
+        unlink(path.data());
+        Handle = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (Handle == -1 || bind(Handle, reinterpret_cast<sockaddr*>(&unixAddress), sizeof(unixAddress)) || listen(Handle, kBacklog))
+        {
+            SDL_Log("Failed to listen on %s: %s", address.data(), std::strerror(errno));
+            Close();
+            return false;
+        }
+        Path = path;
+        SetOptions(Handle, false);
+        return true;
+    }
+    addrinfo* info = GetTCPAddress(address, true);
+    if (!info)
+    {
+        return false;
+    }
+    for (addrinfo* i = info; i; i = i->ai_next)
+    {
+        Handle = socket(i->ai_family, i->ai_socktype, i->ai_protocol);
+        if (Handle == -1)
+        {
+            continue;
+        }
+        int enable = 1;
+        setsockopt(Handle, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        if (!bind(Handle, i->ai_addr, i->ai_addrlen) && !listen(Handle, kBacklog))
+        {
+            break;
+        }
+        close(Handle);
+        Handle = -1;
+    }
+    freeaddrinfo(info);
+    if (Handle == -1)
+    {
+        SDL_Log("Failed to listen on %s: %s", address.data(), std::strerror(errno));
+        return false;
+    }
+    SetOptions(Handle, false);
+    return true;
+}
+
+void Listener::Close()
+{
+    if (!Path.empty())
+    {
+        unlink(Path.data());
+    }
+    Release();
+}
+
+void Listener::Release()
+{
+    if (Handle != -1)
+    {
+        close(Handle);
+        Handle = -1;
+    }
+    Path.clear();
+}
+
+bool Listener::Accept(Connection& connection)
+{
+    sockaddr_storage address;
+    socklen_t size = sizeof(address);
+    int handle = accept(Handle, reinterpret_cast<sockaddr*>(&address), &size);
+    if (handle == -1)
+    {
+        SDL_Log("Failed to accept connection: %s", std::strerror(errno));
+        return false;
+    }
+    connection.Close();
+    connection.Handle = handle;
+    SetOptions(handle, address.ss_family != AF_UNIX);
+    return true;
+}
+
+int Listener::GetHandle() const
+{
+    return Handle;
+}
\ No newline at end of file
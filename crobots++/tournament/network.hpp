@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "protocol.hpp"
+
+// addresses are either unix:<path> or <host>:<port>
+class Connection
+{
+public:
+    Connection();
+    Connection(const Connection& other) = delete;
+    Connection& operator=(const Connection& other) = delete;
+    Connection(Connection&& other);
+    Connection& operator=(Connection&& other);
+    ~Connection();
+    bool Connect(const std::string& address);
+    // connects two local ends, e.g. for a parent and a forked child
+    static bool Pair(Connection& a, Connection& b);
+    void Close();
+    // blocks until the whole frame is written
+    bool Send(const std::vector<uint8_t>& frame);
+    // for non-blocking sockets. queues the frame behind any pending output and writes as much as the socket takes
+    bool Post(const std::vector<uint8_t>& frame);
+    // writes pending output until the socket would block. false once the peer is gone
+    bool Flush();
+    // bytes posted but not yet written
+    size_t GetPending() const;
+    bool SetBlocking(bool blocking);
+    // reads whatever is available without blocking past the first read. false once the peer is gone
+    bool Receive();
+    // pops the next complete frame, if there is one
+    bool Pop(MessageType& type, std::vector<uint8_t>& payload);
+    // blocks until a complete frame arrives
+    bool Wait(MessageType& type, std::vector<uint8_t>& payload);
+    // received bytes that haven't been popped, for peers that don't speak in frames
+    std::string_view GetInput() const;
+    int GetHandle() const;
+
+private:
+    friend class Listener;
+
+    int Handle;
+    std::vector<uint8_t> Input;
+    size_t Offset;
+    std::vector<uint8_t> Output;
+};
+
+class Listener
+{
+public:
+    Listener();
+    ~Listener();
+    bool Listen(const std::string& address);
+    void Close();
+    // closes the handle but leaves the socket path to whoever else is using it
+    void Release();
+    bool Accept(Connection& connection);
+    int GetHandle() const;
+
+private:
+    int Handle;
+    std::string Path;
+};
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <SDL3/SDL.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "coordinator.hpp"
+#include "engine.hpp"
+#include "match.hpp"
+#include "module.hpp"
+#include "network.hpp"
+#include "pool.hpp"
+#include "session.hpp"
+
+// a match per shard so a crash only ever costs the match that caused it
+static constexpr int kShardSize = 1;
+
+ProcessPool::ProcessPool()
+    : Simulation{}
+    , Params{}
+    , Children{}
+    , Processes{0}
+    , Initialized{false}
+{
+}
+
+bool ProcessPool::Init(const EngineParams& params, int processes)
+{
+    Params = params;
+    Processes = processes;
+    // everything loaded here is shared with the children instead of being loaded once per child
+    for (const std::string& robot : Params.Robots)
+    {
+        if (!ModuleRegistry::Load(robot))
+        {
+            SDL_Log("Failed to load robot: %s", robot.data());
+            return false;
+        }
+    }
+    EngineParams engineParams = Params;
+    engineParams.Robots.resize(2, Params.Robots.front());
+    Initialized = Simulation.Init(engineParams);
+    if (!Initialized)
+    {
+        SDL_Log("Failed to initialize engine");
+        return false;
+    }
+    return true;
+}
+
+void ProcessPool::Destroy()
+{
+    if (Initialized)
+    {
+        Simulation.Destroy();
+        Initialized = false;
+    }
+}
+
+bool ProcessPool::Fork(Coordinator& coordinator)
+{
+    Connection parent;
+    Connection child;
+    if (!Connection::Pair(parent, child))
+    {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        SDL_Log("Failed to fork: %s", std::strerror(errno));
+        return false;
+    }
+    if (!pid)
+    {
+        // let go of every other child's socket so their parent side sees them hang up
+        parent.Close();
+        coordinator.Close();
+        bool initialized = true;
+        bool success = RunSession(child, Simulation, Params, initialized);
+        // skip destructors and atexit handlers, they belong to the parent
+        _exit(success ? 0 : 1);
+    }
+    Children.emplace(parent.GetHandle(), pid);
+    coordinator.Add(std::move(parent));
+    return true;
+}
+
+void ProcessPool::Reap(pid_t pid)
+{
+    int status;
+    while (waitpid(pid, &status, 0) == -1)
+    {
+        if (errno != EINTR)
+        {
+            return;
+        }
+    }
+    if (WIFSIGNALED(status) && WTERMSIG(status) != SIGKILL)
+    {
+        SDL_Log("Worker %d crashed: %s", int(pid), strsignal(WTERMSIG(status)));
+    }
+    else if (WIFEXITED(status) && WEXITSTATUS(status))
+    {
+        SDL_Log("Worker %d failed: %d", int(pid), WEXITSTATUS(status));
+    }
+}
+
+bool ProcessPool::Run(const std::vector<Match>& schedule, const ResultCallback& callback)
+{
+    Coordinator coordinator;
+    coordinator.SetDropCallback([&](int handle)
+    {
+        auto iterator = Children.find(handle);
+        if (iterator == Children.end())
+        {
+            return;
+        }
+        pid_t pid = iterator->second;
+        Children.erase(iterator);
+        // it may only have broken the protocol, so make sure it's gone before replacing it
+        kill(pid, SIGKILL);
+        Reap(pid);
+        if (!Fork(coordinator))
+        {
+            SDL_Log("Failed to replace worker %d", int(pid));
+        }
+    });
+    bool success = true;
+    for (int i = 0; success && i < Processes; i++)
+    {
+        success = Fork(coordinator);
+    }
+    success = success && coordinator.Run(Params, schedule, kShardSize, callback);
+    // children exit on quit, or on hang up if the run failed
+    coordinator.Close();
+    for (auto& [handle, pid] : Children)
+    {
+        Reap(pid);
+    }
+    Children.clear();
+    return success;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "coordinator.hpp"
+#include "engine.hpp"
+#include "match.hpp"
+
+// plays matches in forked children that share the parent's loaded modules and warm engine copy on write.
+// each child is isolated from the others, and one that crashes is replaced and its match retried
+class ProcessPool
+{
+public:
+    ProcessPool();
+    bool Init(const EngineParams& params, int processes);
+    void Destroy();
+    bool Run(const std::vector<Match>& schedule, const ResultCallback& callback);
+
+private:
+    bool Fork(Coordinator& coordinator);
+    void Reap(pid_t pid);
+
+    Engine Simulation;
+    EngineParams Params;
+    // keyed by the handle of the parent's end of the child's socket
+    std::unordered_map<int, pid_t> Children;
+    int Processes;
+    bool Initialized;
+};
\ No newline at end of file
@@ -0,0 +1,377 @@
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "map.hpp"
+#include "match.hpp"
+#include "protocol.hpp"
+
+static constexpr uint32_t kMaxCount = 1024 * 1024;
+
+Writer::Writer(std::vector<uint8_t>& frame, MessageType type)
+    : Frame{frame}
+{
+    Frame.assign(kFrameHeader, 0);
+    Frame[4] = uint8_t(type);
+}
+
+Writer::~Writer()
+{
+    // patch the size in now that the payload is known
+    uint32_t size = Frame.size() - kFrameHeader;
+    for (int i = 0; i < 4; i++)
+    {
+        Frame[i] = uint8_t(size >> (i * 8));
+    }
+}
+
+void Writer::Write(uint8_t value)
+{
+    Frame.push_back(value);
+}
+
+void Writer::Write(uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        Frame.push_back(uint8_t(value >> (i * 8)));
+    }
+}
+
+void Writer::Write(uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        Frame.push_back(uint8_t(value >> (i * 8)));
+    }
+}
+
+void Writer::Write(float value)
+{
+    Write(std::bit_cast<uint32_t>(value));
+}
+
+void Writer::Write(const std::string& value)
+{
+    Write(uint32_t(value.size()));
+    Frame.insert(Frame.end(), value.begin(), value.end());
+}
+
+void Writer::Write(const std::vector<uint8_t>& value)
+{
+    Write(uint32_t(value.size()));
+    Frame.insert(Frame.end(), value.begin(), value.end());
+}
+
+void Writer::WriteVarint(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        Frame.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    Frame.push_back(uint8_t(value));
+}
+
+Reader::Reader(const std::vector<uint8_t>& payload)
+    : Payload{payload}
+    , Offset{0}
+{
+}
+
+bool Reader::Read(uint8_t& value)
+{
+    if (Offset + 1 > Payload.size())
+    {
+        return false;
+    }
+    value = Payload[Offset++];
+    return true;
+}
+
+bool Reader::Read(uint32_t& value)
+{
+    if (Offset + 4 > Payload.size())
+    {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value |= uint32_t(Payload[Offset++]) << (i * 8);
+    }
+    return true;
+}
+
+bool Reader::Read(uint64_t& value)
+{
+    if (Offset + 8 > Payload.size())
+    {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        value |= uint64_t(Payload[Offset++]) << (i * 8);
+    }
+    return true;
+}
+
+bool Reader::Read(float& value)
+{
+    uint32_t bits;
+    if (!Read(bits))
+    {
+        return false;
+    }
+    value = std::bit_cast<float>(bits);
+    return true;
+}
+
+bool Reader::Read(std::string& value)
+{
+    uint32_t size;
+    if (!Read(size) || Offset + size > Payload.size())
+    {
+        return false;
+    }
+    value.assign(Payload.begin() + Offset, Payload.begin() + Offset + size);
+    Offset += size;
+    return true;
+}
+
+bool Reader::Read(std::vector<uint8_t>& value)
+{
+    uint32_t size;
+    if (!Read(size) || Offset + size > Payload.size())
+    {
+        return false;
+    }
+    value.assign(Payload.begin() + Offset, Payload.begin() + Offset + size);
+    Offset += size;
+    return true;
+}
+
+bool Reader::ReadVarint(uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 32; shift += 7)
+    {
+        if (Offset == Payload.size())
+        {
+            return false;
+        }
+        uint8_t byte = Payload[Offset++];
+        value |= uint32_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Reader::IsDone() const
+{
+    return Offset == Payload.size();
+}
+
+void Encode(std::vector<uint8_t>& frame, MessageType type)
+{
+    Writer writer{frame, type};
+}
+
+void Encode(std::vector<uint8_t>& frame, const ShardMessage& message)
+{
+    Writer writer{frame, MessageType::Shard};
+    const EngineParams& params = message.Params;
+    writer.Write(message.ID);
+    writer.Write(params.Timestep);
+    writer.Write(params.Duration);
+    writer.Write(uint32_t(params.SubSteps));
+    writer.Write(uint8_t(params.Settle));
+    writer.Write(uint8_t(params.Physics));
+    writer.Write(uint32_t(params.Teams.size()));
+    for (int team : params.Teams)
+    {
+        writer.Write(uint32_t(team));
+    }
+    writer.Write(uint8_t(params.Layout != nullptr));
+    if (params.Layout)
+    {
+        std::vector<uint8_t> map;
+        params.Layout->Save(map);
+        writer.Write(map);
+    }
+    writer.Write(uint32_t(params.Robots.size()));
+    for (const std::string& robot : params.Robots)
+    {
+        writer.Write(robot);
+    }
+    writer.Write(uint32_t(message.Matches.size()));
+    for (const Match& match : message.Matches)
+    {
+        writer.Write(match.Seed);
+        writer.Write(uint32_t(match.Lineup.size()));
+        for (int robot : match.Lineup)
+        {
+            writer.Write(uint32_t(robot));
+        }
+        writer.Write(uint32_t(match.Parameters.size()));
+        for (const ParameterValue& parameter : match.Parameters)
+        {
+            writer.Write(uint32_t(parameter.Slot));
+            writer.Write(parameter.Name);
+            writer.Write(parameter.Value);
+        }
+    }
+}
+
+void Encode(std::vector<uint8_t>& frame, const ResultMessage& message)
+{
+    Writer writer{frame, MessageType::Result};
+    writer.Write(message.Shard);
+    writer.Write(message.Match);
+    writer.Write(uint32_t(message.Results.size()));
+    for (const RobotResult& result : message.Results)
+    {
+        writer.Write(uint32_t(result.Placement));
+        writer.Write(result.Damage);
+        writer.Write(result.DamageDealt);
+        writer.Write(result.Time);
+    }
+}
+
+void Encode(std::vector<uint8_t>& frame, uint32_t shard)
+{
+    Writer writer{frame, MessageType::Done};
+    writer.Write(shard);
+}
+
+bool Decode(const std::vector<uint8_t>& payload, ShardMessage& message)
+{
+    Reader reader{payload};
+    EngineParams& params = message.Params;
+    params = {};
+    uint32_t subSteps;
+    uint8_t settle;
+    uint8_t physics;
+    uint32_t teams;
+    if (!reader.Read(message.ID) || !reader.Read(params.Timestep) || !reader.Read(params.Duration) ||
+        !reader.Read(subSteps) || !reader.Read(settle) || !reader.Read(physics) ||
+        physics > uint8_t(PhysicsType::Batch) || !reader.Read(teams) || teams > kMaxRobots)
+    {
+        return false;
+    }
+    params.SubSteps = subSteps;
+    params.Settle = settle;
+    params.Physics = PhysicsType(physics);
+    params.Teams.resize(teams);
+    for (int& team : params.Teams)
+    {
+        uint32_t value;
+        if (!reader.Read(value))
+        {
+            return false;
+        }
+        team = value;
+    }
+    uint8_t layout;
+    if (!reader.Read(layout))
+    {
+        return false;
+    }
+    if (layout)
+    {
+        std::vector<uint8_t> data;
+        std::shared_ptr<Map> map = std::make_shared<Map>();
+        if (!reader.Read(data) || !map->Parse(data))
+        {
+            return false;
+        }
+        params.Layout = map;
+    }
+    uint32_t robots;
+    if (!reader.Read(robots) || robots > kMaxCount)
+    {
+        return false;
+    }
+    params.Robots.resize(robots);
+    for (std::string& robot : params.Robots)
+    {
+        if (!reader.Read(robot))
+        {
+            return false;
+        }
+    }
+    uint32_t matches;
+    if (!reader.Read(matches) || matches > kMaxCount)
+    {
+        return false;
+    }
+    message.Matches.resize(matches);
+    for (Match& match : message.Matches)
+    {
+        uint32_t lineup;
+        if (!reader.Read(match.Seed) || !reader.Read(lineup) || lineup > 8)
+        {
+            return false;
+        }
+        match.Lineup.resize(lineup);
+        for (int& robot : match.Lineup)
+        {
+            uint32_t index;
+            if (!reader.Read(index) || index >= robots)
+            {
+                return false;
+            }
+            robot = index;
+        }
+        uint32_t parameters;
+        if (!reader.Read(parameters) || parameters > kMaxCount)
+        {
+            return false;
+        }
+        match.Parameters.resize(parameters);
+        for (ParameterValue& parameter : match.Parameters)
+        {
+            uint32_t slot;
+            if (!reader.Read(slot) || slot >= lineup || !reader.Read(parameter.Name) || !reader.Read(parameter.Value))
+            {
+                return false;
+            }
+            parameter.Slot = slot;
+        }
+    }
+    return reader.IsDone();
+}
+
+bool Decode(const std::vector<uint8_t>& payload, ResultMessage& message)
+{
+    Reader reader{payload};
+    uint32_t count;
+    if (!reader.Read(message.Shard) || !reader.Read(message.Match) || !reader.Read(count) || count > 8)
+    {
+        return false;
+    }
+    message.Results.resize(count);
+    for (RobotResult& result : message.Results)
+    {
+        uint32_t placement;
+        if (!reader.Read(placement) || !reader.Read(result.Damage) || !reader.Read(result.DamageDealt) || !reader.Read(result.Time))
+        {
+            return false;
+        }
+        result.Placement = placement;
+    }
+    return reader.IsDone();
+}
+
+bool Decode(const std::vector<uint8_t>& payload, uint32_t& shard)
+{
+    Reader reader{payload};
+    return reader.Read(shard) && reader.IsDone();
+}
\ No newline at end of file
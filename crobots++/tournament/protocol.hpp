@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "match.hpp"
+
+// every frame is a little endian uint32 payload size, a uint8 type and the payload
+static constexpr int kFrameHeader = 5;
+static constexpr uint32_t kMaxFrame = 64 * 1024 * 1024;
+
+enum class MessageType : uint8_t
+{
+    // worker -> coordinator: ready for another shard
+    Request,
+    // coordinator -> worker: engine settings and the matches to play
+    Shard,
+    // worker -> coordinator: results for one match of the current shard
+    Result,
+    // worker -> coordinator: every match of the current shard was sent
+    Done,
+    // coordinator -> worker: nothing is left
+    Quit,
+    // host -> spectator: robots and projectiles of one tick, possibly as a delta
+    Snapshot,
+    // spectator -> host: the newest snapshot decoded, later deltas are taken against it
+    Ack,
+    // spectator -> host: the part of the arena it can see
+    Interest,
+};
+
+struct ShardMessage
+{
+    uint32_t ID;
+    // everything that changes how a match plays. Seed comes with each match and Arena never leaves the process
+    EngineParams Params;
+    std::vector<Match> Matches;
+};
+
+struct ResultMessage
+{
+    uint32_t Shard;
+    // index into the shard's matches
+    uint32_t Match;
+    std::vector<RobotResult> Results;
+};
+
+class Writer
+{
+public:
+    Writer(std::vector<uint8_t>& frame, MessageType type);
+    ~Writer();
+    void Write(uint8_t value);
+    void Write(uint32_t value);
+    void Write(uint64_t value);
+    void Write(float value);
+    void Write(const std::string& value);
+    void Write(const std::vector<uint8_t>& value);
+    // seven bits per byte, so small values stay small
+    void WriteVarint(uint32_t value);
+
+private:
+    std::vector<uint8_t>& Frame;
+};
+
+class Reader
+{
+public:
+    Reader(const std::vector<uint8_t>& payload);
+    bool Read(uint8_t& value);
+    bool Read(uint32_t& value);
+    bool Read(uint64_t& value);
+    bool Read(float& value);
+    bool Read(std::string& value);
+    bool Read(std::vector<uint8_t>& value);
+    bool ReadVarint(uint32_t& value);
+    bool IsDone() const;
+
+private:
+    const std::vector<uint8_t>& Payload;
+    size_t Offset;
+};
+
+void Encode(std::vector<uint8_t>& frame, MessageType type);
+void Encode(std::vector<uint8_t>& frame, const ShardMessage& message);
+void Encode(std::vector<uint8_t>& frame, const ResultMessage& message);
+void Encode(std::vector<uint8_t>& frame, uint32_t shard);
+bool Decode(const std::vector<uint8_t>& payload, ShardMessage& message);
+bool Decode(const std::vector<uint8_t>& payload, ResultMessage& message);
+bool Decode(const std::vector<uint8_t>& payload, uint32_t& shard);
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <numbers>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "rating.hpp"
+
+static constexpr const char* kHeader = "crobots++-ratings";
+// names are quoted from version 2 on. quoted reads still take the bare names of version 1
+static constexpr int kVersion = 2;
+static constexpr double kEloStart = 1500.0;
+static constexpr double kEloK = 32.0;
+static constexpr double kGlickoStart = 1500.0;
+static constexpr double kGlickoDeviation = 350.0;
+static constexpr double kGlickoVolatility = 0.06;
+static constexpr double kGlickoScale = 173.7178;
+static constexpr double kGlickoTau = 0.5;
+static constexpr double kGlickoEpsilon = 0.000001;
+static constexpr double kMu = 25.0;
+static constexpr double kSigma = kMu / 3.0;
+static constexpr double kBeta = kSigma / 2.0;
+static constexpr double kKappa = 0.0001;
+
+static double GetPairScore(const Outcome& a, const Outcome& b)
+{
+    if (a.Placement < b.Placement)
+    {
+        return 1.0;
+    }
+    if (a.Placement > b.Placement)
+    {
+        return 0.0;
+    }
+    return 0.5;
+}
+
+Rating::Rating()
+    : Name{}
+    , Elo{kEloStart}
+    , Glicko{kGlickoStart}
+    , GlickoDeviation{kGlickoDeviation}
+    , GlickoVolatility{kGlickoVolatility}
+    , Mu{kMu}
+    , Sigma{kSigma}
+    , Matches{0}
+    , Wins{0}
+    , DamageDealt{0.0}
+    , DamageTaken{0.0}
+    , Time{0.0}
+{
+}
+
+double Rating::GetScore(RatingSystem system) const
+{
+    // conservative estimates so barely played robots don't top the table
+    switch (system)
+    {
+    case RatingSystem::Elo:
+        return Elo;
+    case RatingSystem::Glicko:
+        return Glicko - 2.0 * GlickoDeviation;
+    case RatingSystem::WengLin:
+        return Mu - 3.0 * Sigma;
+    }
+    return 0.0;
+}
+
+Ratings::Ratings()
+    : Mutex{}
+    , WriteMutex{}
+    , Players{}
+    , Names{}
+    , Before{}
+    , CheckpointPath{}
+    , CheckpointInterval{0}
+    , Matches{0}
+{
+}
+
+bool Ratings::Load(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (file.fail())
+    {
+        SDL_Log("Failed to open ratings: %s", path.string().data());
+        return false;
+    }
+    std::error_code error;
+    uint64_t limit = std::filesystem::file_size(path, error);
+    std::string header;
+    int version;
+    uint64_t matches;
+    int count;
+    file >> header >> version >> matches >> count;
+    // every player takes more than a byte, so a count past the file size is a corrupt header
+    if (file.fail() || header != kHeader || version < 1 || version > kVersion || count < 0 || count > limit)
+    {
+        SDL_Log("Failed to parse ratings: %s", path.string().data());
+        return false;
+    }
+    std::vector<Rating> players(count);
+    for (Rating& player : players)
+    {
+        file >> std::quoted(player.Name) >> player.Elo >> player.Glicko >> player.GlickoDeviation >> player.GlickoVolatility
+            >> player.Mu >> player.Sigma >> player.Matches >> player.Wins >> player.DamageDealt >> player.DamageTaken >> player.Time;
+    }
+    if (file.fail())
+    {
+        SDL_Log("Failed to parse ratings: %s", path.string().data());
+        return false;
+    }
+    std::lock_guard lock{Mutex};
+    Players = std::move(players);
+    Names.clear();
+    for (int i = 0; i < Players.size(); i++)
+    {
+        Names.emplace(Players[i].Name, i);
+    }
+    Matches = matches;
+    return true;
+}
+
+bool Ratings::Save(const std::filesystem::path& path) const
+{
+    std::vector<Rating> players;
+    uint64_t matches;
+    {
+        std::lock_guard lock{Mutex};
+        players = Players;
+        matches = Matches;
+    }
+    return Write(path, players, matches);
+}
+
+void Ratings::SetCheckpoint(const std::filesystem::path& path, uint64_t interval)
+{
+    std::lock_guard lock{Mutex};
+    CheckpointPath = path;
+    CheckpointInterval = interval;
+}
+
+int Ratings::GetPlayer(const std::string_view& name)
+{
+    std::lock_guard lock{Mutex};
+    auto [iterator, inserted] = Names.try_emplace(std::string{name}, int(Players.size()));
+    if (inserted)
+    {
+        Players.emplace_back().Name = name;
+    }
+    return iterator->second;
+}
+
+void Ratings::Submit(const Outcome* outcomes, int count)
+{
+    std::vector<Rating> players;
+    uint64_t matches;
+    std::filesystem::path path;
+    {
+        std::lock_guard lock{Mutex};
+        Before.clear();
+        for (int i = 0; i < count; i++)
+        {
+            SDL_assert(outcomes[i].Player >= 0 && outcomes[i].Player < Players.size());
+            Before.push_back(Players[outcomes[i].Player]);
+        }
+        // every system reads the pre-match copies so the order of outcomes doesn't matter.
+        // a player listed twice in one match keeps the ratings from its last slot
+        UpdateElo(outcomes, count);
+        UpdateGlicko(outcomes, count);
+        UpdateWengLin(outcomes, count);
+        for (int i = 0; i < count; i++)
+        {
+            const Outcome& outcome = outcomes[i];
+            Rating& player = Players[outcome.Player];
+            player.Matches++;
+            player.Wins += outcome.Placement == 1;
+            player.DamageDealt += outcome.DamageDealt;
+            player.DamageTaken += outcome.DamageTaken;
+            player.Time += outcome.Time;
+        }
+        Matches++;
+        if (!CheckpointInterval || Matches % CheckpointInterval)
+        {
+            return;
+        }
+        players = Players;
+        matches = Matches;
+        path = CheckpointPath;
+    }
+    // written outside the lock so submitters and queries aren't held up by disk
+    if (!Write(path, players, matches))
+    {
+        SDL_Log("Failed to checkpoint ratings: %s", path.string().data());
+    }
+}
+
+std::vector<Rating> Ratings::GetLeaderboard(RatingSystem system) const
+{
+    std::vector<Rating> players;
+    {
+        std::lock_guard lock{Mutex};
+        players = Players;
+    }
+    std::sort(players.begin(), players.end(), [system](const Rating& a, const Rating& b)
+    {
+        return a.GetScore(system) > b.GetScore(system);
+    });
+    return players;
+}
+
+uint64_t Ratings::GetMatches() const
+{
+    std::lock_guard lock{Mutex};
+    return Matches;
+}
+
+bool Ratings::Write(const std::filesystem::path& path, const std::vector<Rating>& players, uint64_t matches) const
+{
+    std::lock_guard lock{WriteMutex};
+    // write next to the target and rename so a crash never leaves a torn checkpoint
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (file.fail())
+        {
+            SDL_Log("Failed to open ratings: %s", temporary.string().data());
+            return false;
+        }
+        file.precision(17);
+        file << kHeader << ' ' << kVersion << ' ' << matches << ' ' << players.size() << '\n';
+        for (const Rating& player : players)
+        {
+            file << std::quoted(player.Name) << ' ' << player.Elo << ' ' << player.Glicko << ' ' << player.GlickoDeviation << ' '
+                << player.GlickoVolatility << ' ' << player.Mu << ' ' << player.Sigma << ' ' << player.Matches << ' '
+                << player.Wins << ' ' << player.DamageDealt << ' ' << player.DamageTaken << ' ' << player.Time << '\n';
+        }
+        if (file.fail())
+        {
+            SDL_Log("Failed to write ratings: %s", temporary.string().data());
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+        SDL_Log("Failed to rename ratings: %s", error.message().data());
+        return false;
+    }
+    return true;
+}
+
+void Ratings::UpdateElo(const Outcome* outcomes, int count)
+{
+    // multiplayer elo: every pair is a game worth 1 / (n - 1) of a head to head
+    for (int i = 0; i < count; i++)
+    {
+        double delta = 0.0;
+        for (int j = 0; j < count; j++)
+        {
+            if (outcomes[i].Player == outcomes[j].Player)
+            {
+                continue;
+            }
+            double expected = 1.0 / (1.0 + std::pow(10.0, (Before[j].Elo - Before[i].Elo) / 400.0));
+            delta += GetPairScore(outcomes[i], outcomes[j]) - expected;
+        }
+        Players[outcomes[i].Player].Elo = Before[i].Elo + kEloK * delta / std::max(count - 1, 1);
+    }
+}
+
+void Ratings::UpdateGlicko(const Outcome* outcomes, int count)
+{
+    // glicko-2 with the match as a rating period against every other robot in it
+    for (int i = 0; i < count; i++)
+    {
+        double mu = (Before[i].Glicko - kGlickoStart) / kGlickoScale;
+        double phi = Before[i].GlickoDeviation / kGlickoScale;
+        double sigma = Before[i].GlickoVolatility;
+        double variance = 0.0;
+        double improvement = 0.0;
+        for (int j = 0; j < count; j++)
+        {
+            if (outcomes[i].Player == outcomes[j].Player)
+            {
+                continue;
+            }
+            double opponentMu = (Before[j].Glicko - kGlickoStart) / kGlickoScale;
+            double opponentPhi = Before[j].GlickoDeviation / kGlickoScale;
+            double g = 1.0 / std::sqrt(1.0 + 3.0 * opponentPhi * opponentPhi / (std::numbers::pi * std::numbers::pi));
+            double expected = 1.0 / (1.0 + std::exp(-g * (mu - opponentMu)));
+            variance += g * g * expected * (1.0 - expected);
+            improvement += g * (GetPairScore(outcomes[i], outcomes[j]) - expected);
+        }
+        if (variance <= 0.0)
+        {
+            continue;
+        }
+        variance = 1.0 / variance;
+        double delta = variance * improvement;
+        double a = std::log(sigma * sigma);
+        auto f = [&](double x)
+        {
+            double ex = std::exp(x);
+            double d = phi * phi + variance + ex;
+            return ex * (delta * delta - phi * phi - variance - ex) / (2.0 * d * d) - (x - a) / (kGlickoTau * kGlickoTau);
+        };
+        double A = a;
+        double B;
+        if (delta * delta > phi * phi + variance)
+        {
+            B = std::log(delta * delta - phi * phi - variance);
+        }
+        else
+        {
+            int k = 1;
+            while (f(a - k * kGlickoTau) < 0.0)
+            {
+                k++;
+            }
+            B = a - k * kGlickoTau;
+        }
+        double fA = f(A);
+        double fB = f(B);
+        while (std::abs(B - A) > kGlickoEpsilon)
+        {
+            double C = A + (A - B) * fA / (fB - fA);
+            double fC = f(C);
+            if (fC * fB <= 0.0)
+            {
+                A = B;
+                fA = fB;
+            }
+            else
+            {
+                fA /= 2.0;
+            }
+            B = C;
+            fB = fC;
+        }
+        sigma = std::exp(A / 2.0);
+        double phiStar = std::sqrt(phi * phi + sigma * sigma);
+        phi = 1.0 / std::sqrt(1.0 / (phiStar * phiStar) + 1.0 / variance);
+        mu += phi * phi * improvement;
+        Rating& player = Players[outcomes[i].Player];
+        player.Glicko = mu * kGlickoScale + kGlickoStart;
+        player.GlickoDeviation = phi * kGlickoScale;
+        player.GlickoVolatility = sigma;
+    }
+}
+
+void Ratings::UpdateWengLin(const Outcome* outcomes, int count)
+{
+    // weng and lin (2011), bradley-terry full pairing
+    for (int i = 0; i < count; i++)
+    {
+        double mu = Before[i].Mu;
+        double variance = Before[i].Sigma * Before[i].Sigma;
+        double omega = 0.0;
+        double delta = 0.0;
+        for (int j = 0; j < count; j++)
+        {
+            if (outcomes[i].Player == outcomes[j].Player)
+            {
+                continue;
+            }
+            double c = std::sqrt(variance + Before[j].Sigma * Before[j].Sigma + 2.0 * kBeta * kBeta);
+            double p = 1.0 / (1.0 + std::exp((Before[j].Mu - mu) / c));
+            double gamma = std::sqrt(variance) / c;
+            omega += variance / c * (GetPairScore(outcomes[i], outcomes[j]) - p);
+            delta += gamma * variance / (c * c) * p * (1.0 - p);
+        }
+        Rating& player = Players[outcomes[i].Player];
+        player.Mu = mu + omega;
+        player.Sigma = std::sqrt(variance * std::max(1.0 - delta, kKappa));
+    }
+}
\ No newline at end of file
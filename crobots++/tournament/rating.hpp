@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class RatingSystem
+{
+    Elo,
+    Glicko,
+    WengLin,
+};
+
+// one robot's result in one match
+struct Outcome
+{
+    int Player;
+    // 1 is first, tied robots share a placement
+    int Placement;
+    float DamageDealt;
+    float DamageTaken;
+    float Time;
+};
+
+struct Rating
+{
+    Rating();
+    double GetScore(RatingSystem system) const;
+
+    std::string Name;
+    double Elo;
+    double Glicko;
+    double GlickoDeviation;
+    double GlickoVolatility;
+    // weng-lin bayesian approximation (the model behind trueskill-like systems)
+    double Mu;
+    double Sigma;
+    uint64_t Matches;
+    uint64_t Wins;
+    double DamageDealt;
+    double DamageTaken;
+    double Time;
+};
+
+// incrementally updated ratings table. safe to submit and query from different threads
+class Ratings
+{
+public:
+    Ratings();
+    bool Load(const std::filesystem::path& path);
+    bool Save(const std::filesystem::path& path) const;
+    void SetCheckpoint(const std::filesystem::path& path, uint64_t interval);
+    int GetPlayer(const std::string_view& name);
+    void Submit(const Outcome* outcomes, int count);
+    std::vector<Rating> GetLeaderboard(RatingSystem system) const;
+    uint64_t GetMatches() const;
+
+private:
+    bool Write(const std::filesystem::path& path, const std::vector<Rating>& players, uint64_t matches) const;
+    void UpdateElo(const Outcome* outcomes, int count);
+    void UpdateGlicko(const Outcome* outcomes, int count);
+    void UpdateWengLin(const Outcome* outcomes, int count);
+
+    mutable std::mutex Mutex;
+    // serializes checkpoint files, which are written without holding the table lock
+    mutable std::mutex WriteMutex;
+    std::vector<Rating> Players;
+    std::unordered_map<std::string, int> Names;
+    // pre-match copies of the players in the match being submitted
+    std::vector<Rating> Before;
+    std::filesystem::path CheckpointPath;
+    uint64_t CheckpointInterval;
+    uint64_t Matches;
+};
\ No newline at end of file
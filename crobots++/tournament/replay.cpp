@@ -0,0 +1,135 @@
+#include <SDL3/SDL.h>
+#include <box2d/box2d.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include "commands.hpp"
+#include "engine.hpp"
+#include "module.hpp"
+
+static bool GetParams(int argc, char** argv, std::filesystem::path& path, int& repeat)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string outer = argv[i];
+        if (i + 1 == argc)
+        {
+            SDL_Log("Missing value: %s", outer.data());
+            return false;
+        }
+        std::string inner = argv[++i];
+        try
+        {
+            if (outer == "--commands")
+            {
+                path = inner;
+            }
+            else if (outer == "--repeat")
+            {
+                repeat = std::stoi(inner);
+            }
+            else
+            {
+                SDL_Log("Unknown argument: %s", outer.data());
+                return false;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            SDL_Log("Failed to parse %s: %s", outer.data(), e.what());
+            return false;
+        }
+    }
+    if (path.empty())
+    {
+        SDL_Log("Must have a command log to replay");
+        return false;
+    }
+    if (repeat < 1)
+    {
+        SDL_Log("Must repeat at least once: %d", repeat);
+        return false;
+    }
+    return true;
+}
+
+// re-drives a recorded match through the engine with no robot code loaded, so only the engine is measured
+int main(int argc, char** argv)
+{
+    std::filesystem::path path;
+    int repeat = 10;
+    if (!GetParams(argc, argv, path, repeat))
+    {
+        return 1;
+    }
+    CommandLog log;
+    if (!log.Load(path))
+    {
+        SDL_Log("Failed to load command log");
+        return 1;
+    }
+    const EngineParams& params = log.GetParams();
+    // box2d tallies what it has live, so the difference is this match's world
+    int worldBytes = b2GetByteCount();
+    Engine engine;
+    engine.SetReplay(&log);
+    if (!engine.Init(params))
+    {
+        SDL_Log("Failed to initialize engine");
+        return 1;
+    }
+    engine.SetDebug(false);
+    // an untimed pass first to check the replay reproduces the recording
+    if (log.GetHash())
+    {
+        engine.SetHashing(true);
+        while (engine.GetTicks() < log.GetTicks())
+        {
+            engine.Tick();
+        }
+        if (engine.GetHash() != log.GetHash())
+        {
+            SDL_Log("Replay diverged from the recording: %016llx, expected %016llx",
+                (unsigned long long) engine.GetHash(), (unsigned long long) log.GetHash());
+            engine.Destroy();
+            return 1;
+        }
+        engine.SetHashing(false);
+    }
+    uint64_t best = UINT64_MAX;
+    uint64_t total = 0;
+    for (int i = 0; i < repeat; i++)
+    {
+        if (!engine.Reset(params.Seed, params.Robots))
+        {
+            SDL_Log("Failed to reset engine");
+            engine.Destroy();
+            return 1;
+        }
+        uint64_t start = SDL_GetTicksNS();
+        while (engine.GetTicks() < log.GetTicks())
+        {
+            engine.Tick();
+        }
+        uint64_t time = SDL_GetTicksNS() - start;
+        best = std::min(best, time);
+        total += time;
+    }
+    worldBytes = b2GetByteCount() - worldBytes;
+    uint64_t engineBytes = engine.GetFootprint();
+    engine.Destroy();
+    ModuleRegistry::Unload();
+    uint64_t ticks = std::max<uint64_t>(log.GetTicks(), 1);
+    std::printf("%llu ticks, %d robots, %s\n", (unsigned long long) log.GetTicks(), int(params.Robots.size()),
+        log.GetHash() ? "verified" : "unverified");
+    std::printf("best %.3f ms (%.3f us/tick), mean %.3f ms (%.3f us/tick)\n", best / 1e6, best / 1e3 / ticks,
+        total / 1e6 / repeat, total / 1e3 / repeat / ticks);
+    std::printf("memory per match %.1f KB (world %.1f KB, engine %.1f KB)\n", (worldBytes + engineBytes) / 1024.0,
+        worldBytes / 1024.0, engineBytes / 1024.0);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include <SDL3/SDL.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "engine.hpp"
+#include "match.hpp"
+#include "network.hpp"
+#include "protocol.hpp"
+#include "session.hpp"
+
+// Seed comes with each match and Arena is never sent, everything else has to match the coordinator's
+static bool IsSame(const EngineParams& a, const EngineParams& b)
+{
+    bool sameLayout = a.Layout == b.Layout || (a.Layout && b.Layout && *a.Layout == *b.Layout);
+    return a.Robots == b.Robots && a.Timestep == b.Timestep && a.Duration == b.Duration && a.SubSteps == b.SubSteps &&
+        a.Settle == b.Settle && a.Physics == b.Physics && a.Teams == b.Teams && sameLayout;
+}
+
+bool RunSession(Connection& connection, Engine& engine, EngineParams& params, bool& initialized)
+{
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> payload;
+    ShardMessage shard;
+    ResultMessage result;
+    while (true)
+    {
+        Encode(frame, MessageType::Request);
+        MessageType type;
+        if (!connection.Send(frame) || !connection.Wait(type, payload))
+        {
+            SDL_Log("Lost connection to coordinator");
+            return false;
+        }
+        if (type == MessageType::Quit)
+        {
+            return true;
+        }
+        if (type != MessageType::Shard || !Decode(payload, shard) || shard.Params.Robots.empty())
+        {
+            SDL_Log("Failed to parse shard");
+            return false;
+        }
+        if (!initialized || !IsSame(params, shard.Params))
+        {
+            if (initialized)
+            {
+                engine.Destroy();
+            }
+            params = shard.Params;
+            EngineParams engineParams = params;
+            engineParams.Robots.resize(2, params.Robots.front());
+            initialized = engine.Init(engineParams);
+            if (!initialized)
+            {
+                SDL_Log("Failed to initialize engine");
+                return false;
+            }
+        }
+        result.Shard = shard.ID;
+        for (int i = 0; i < shard.Matches.size(); i++)
+        {
+            if (!RunMatch(engine, params.Robots, shard.Matches[i], result.Results))
+            {
+                SDL_Log("Failed to run match");
+                return false;
+            }
+            // streamed one at a time rather than as a burst at the end of the shard
+            result.Match = i;
+            Encode(frame, result);
+            if (!connection.Send(frame))
+            {
+                SDL_Log("Lost connection to coordinator");
+                return false;
+            }
+        }
+        // dropping the connection instead hands the shard to another worker
+        Encode(frame, shard.ID);
+        if (!connection.Send(frame))
+        {
+            SDL_Log("Lost connection to coordinator");
+            return false;
+        }
+    }
+}
\ No newline at end of file
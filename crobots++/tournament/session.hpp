@@ -0,0 +1,8 @@
+#pragma once
+
+#include "engine.hpp"
+#include "network.hpp"
+
+// plays shards from a coordinator until told to quit. the engine is reused across shards and only
+// reinitialized when the settings change, so a caller can hand in one that is already warm
+bool RunSession(Connection& connection, Engine& engine, EngineParams& params, bool& initialized);
\ No newline at end of file
@@ -0,0 +1,456 @@
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "evaluator.hpp"
+#include "match.hpp"
+#include "module.hpp"
+
+enum class Strategy
+{
+    Grid,
+    Random,
+    Evolution,
+};
+
+struct SweepParams
+{
+    SweepParams();
+
+    EngineParams Engine;
+    std::string Robot;
+    std::vector<std::string> Opponents;
+    std::vector<std::string> Parameters;
+    Strategy Search;
+    int Players;
+    uint64_t Matches;
+    int Threads;
+    int Steps;
+    int Candidates;
+    int Generations;
+    int Population;
+};
+
+SweepParams::SweepParams()
+    : Engine{}
+    , Robot{}
+    , Opponents{}
+    , Parameters{}
+    , Search{Strategy::Random}
+    , Players{2}
+    , Matches{64}
+    , Threads{SDL_GetNumLogicalCPUCores()}
+    , Steps{5}
+    , Candidates{64}
+    , Generations{20}
+    , Population{0}
+{
+}
+
+struct Dimension
+{
+    std::string Name;
+    float Min;
+    float Max;
+};
+
+static bool GetList(int argc, char** argv, int& i, std::vector<std::string>& list)
+{
+    for (; i + 1 < argc; i++)
+    {
+        std::string inner = argv[i + 1];
+        if (inner.starts_with("--"))
+        {
+            break;
+        }
+        list.push_back(inner);
+    }
+    return !list.empty();
+}
+
+static bool GetParams(int argc, char** argv, SweepParams& params)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string outer = argv[i];
+        if (outer == "--opponents" || outer == "--parameters")
+        {
+            if (!GetList(argc, argv, i, outer == "--opponents" ? params.Opponents : params.Parameters))
+            {
+                SDL_Log("Missing value: %s", outer.data());
+                return false;
+            }
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            SDL_Log("Missing value: %s", outer.data());
+            return false;
+        }
+        std::string inner = argv[++i];
+        try
+        {
+            if (outer == "--robot")
+            {
+                params.Robot = inner;
+            }
+            else if (outer == "--timestep")
+            {
+                params.Engine.Timestep = std::stof(inner);
+            }
+            else if (outer == "--duration")
+            {
+                params.Engine.Duration = std::stof(inner);
+            }
+            else if (outer == "--seed")
+            {
+                params.Engine.Seed = std::stoull(inner);
+            }
+            else if (outer == "--players")
+            {
+                params.Players = std::stoi(inner);
+            }
+            else if (outer == "--matches")
+            {
+                params.Matches = std::stoull(inner);
+            }
+            else if (outer == "--threads")
+            {
+                params.Threads = std::stoi(inner);
+            }
+            else if (outer == "--steps")
+            {
+                params.Steps = std::stoi(inner);
+            }
+            else if (outer == "--candidates")
+            {
+                params.Candidates = std::stoi(inner);
+            }
+            else if (outer == "--generations")
+            {
+                params.Generations = std::stoi(inner);
+            }
+            else if (outer == "--population")
+            {
+                params.Population = std::stoi(inner);
+            }
+            else if (outer == "--strategy")
+            {
+                if (inner == "grid")
+                {
+                    params.Search = Strategy::Grid;
+                }
+                else if (inner == "random")
+                {
+                    params.Search = Strategy::Random;
+                }
+                else if (inner == "evolution")
+                {
+                    params.Search = Strategy::Evolution;
+                }
+                else
+                {
+                    SDL_Log("Unknown strategy: %s", inner.data());
+                    return false;
+                }
+            }
+            else
+            {
+                SDL_Log("Unknown argument: %s", outer.data());
+                return false;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            SDL_Log("Failed to parse %s: %s", outer.data(), e.what());
+            return false;
+        }
+    }
+    if (params.Robot.empty())
+    {
+        SDL_Log("Must have a robot to tune");
+        return false;
+    }
+    if (params.Opponents.empty())
+    {
+        params.Opponents.push_back(params.Robot);
+    }
+    if (params.Players < 2 || params.Players > 8)
+    {
+        SDL_Log("Must have between 2 and 8 (inclusive) players: %d", params.Players);
+        return false;
+    }
+    if (params.Threads < 1 || params.Matches < 1 || params.Steps < 2 || params.Candidates < 1 || params.Generations < 1)
+    {
+        SDL_Log("Threads, matches, steps, candidates and generations must be positive");
+        return false;
+    }
+    return true;
+}
+
+static bool GetDimensions(const SweepParams& params, std::vector<Dimension>& dimensions)
+{
+    // parameters are declared on first use, so play a single tick to let the robot announce them
+    EngineParams engineParams = params.Engine;
+    engineParams.Robots = {params.Robot, params.Opponents.front()};
+    Engine engine;
+    if (!engine.Init(engineParams))
+    {
+        SDL_Log("Failed to initialize engine");
+        return false;
+    }
+    engine.Tick();
+    for (const crobots::Parameter& parameter : engine.GetParameters(0))
+    {
+        if (params.Parameters.empty() || std::find(params.Parameters.begin(), params.Parameters.end(), parameter.Name) != params.Parameters.end())
+        {
+            dimensions.emplace_back(parameter.Name, parameter.Min, parameter.Max);
+        }
+    }
+    engine.Destroy();
+    if (dimensions.empty())
+    {
+        SDL_Log("Robot has no tunable parameters: %s", params.Robot.data());
+        return false;
+    }
+    return true;
+}
+
+static void PrintHeader(const std::vector<Dimension>& dimensions)
+{
+    std::printf("generation,candidate,fitness,matches");
+    for (const Dimension& dimension : dimensions)
+    {
+        std::printf(",%s", dimension.Name.data());
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+static void PrintCandidate(int generation, int index, const Candidate& candidate)
+{
+    std::printf("%d,%d,%.6f,%d", generation, index, candidate.Fitness, candidate.Matches);
+    for (float value : candidate.Values)
+    {
+        std::printf(",%g", value);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+static float GetValue(const Dimension& dimension, double normalized)
+{
+    return dimension.Min + (dimension.Max - dimension.Min) * std::clamp(normalized, 0.0, 1.0);
+}
+
+static double GetNormal(uint64_t& state)
+{
+    // box-muller
+    double u = 1.0 - SDL_randf_r(&state);
+    double v = SDL_randf_r(&state);
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * std::numbers::pi * v);
+}
+
+static void Evaluate(Evaluator& evaluator, std::vector<Candidate>& candidates, const std::vector<Dimension>& dimensions,
+    const std::vector<Match>& matches, int generation)
+{
+    std::vector<std::string> names;
+    for (const Dimension& dimension : dimensions)
+    {
+        names.push_back(dimension.Name);
+    }
+    evaluator.Evaluate(candidates, names, matches, [generation](int index, const Candidate& candidate)
+    {
+        PrintCandidate(generation, index, candidate);
+    });
+}
+
+static void SearchGrid(const SweepParams& params, Evaluator& evaluator, const std::vector<Dimension>& dimensions, const std::vector<Match>& matches)
+{
+    uint64_t count = 1;
+    for (int i = 0; i < dimensions.size(); i++)
+    {
+        count *= params.Steps;
+    }
+    std::vector<Candidate> candidates(count);
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t index = i;
+        for (const Dimension& dimension : dimensions)
+        {
+            candidates[i].Values.push_back(GetValue(dimension, double(index % params.Steps) / (params.Steps - 1)));
+            index /= params.Steps;
+        }
+    }
+    Evaluate(evaluator, candidates, dimensions, matches, 0);
+}
+
+static void SearchRandom(const SweepParams& params, Evaluator& evaluator, const std::vector<Dimension>& dimensions, const std::vector<Match>& matches)
+{
+    uint64_t state = params.Engine.Seed;
+    std::vector<Candidate> candidates(params.Candidates);
+    for (Candidate& candidate : candidates)
+    {
+        for (const Dimension& dimension : dimensions)
+        {
+            candidate.Values.push_back(GetValue(dimension, SDL_randf_r(&state)));
+        }
+    }
+    Evaluate(evaluator, candidates, dimensions, matches, 0);
+}
+
+static void SearchEvolution(const SweepParams& params, Evaluator& evaluator, const std::vector<Dimension>& dimensions, const std::vector<Match>& matches)
+{
+    // separable cma-es (ros and hansen, 2008) in the unit cube. diagonal covariance keeps it cheap
+    // in the parameter count, and robots rarely have enough parameters for the full matrix to matter
+    int n = dimensions.size();
+    int lambda = params.Population ? params.Population : 4 + int(3.0 * std::log(n));
+    lambda = std::max(lambda, 2);
+    int mu = lambda / 2;
+    std::vector<double> weights(mu);
+    double sum = 0.0;
+    for (int i = 0; i < mu; i++)
+    {
+        weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+        sum += weights[i];
+    }
+    double squares = 0.0;
+    for (double& weight : weights)
+    {
+        weight /= sum;
+        squares += weight * weight;
+    }
+    double mueff = 1.0 / squares;
+    double cs = (mueff + 2.0) / (n + mueff + 5.0);
+    double ds = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+    double cc = (4.0 + mueff / n) / (n + 4.0 + 2.0 * mueff / n);
+    double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff);
+    double cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((n + 2.0) * (n + 2.0) + mueff));
+    // the separable variant can learn faster than the full one
+    c1 *= (n + 2.0) / 3.0;
+    cmu = std::min(1.0 - c1, cmu * (n + 2.0) / 3.0);
+    double chi = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    std::vector<double> mean(n, 0.5);
+    std::vector<double> variance(n, 1.0);
+    std::vector<double> ps(n, 0.0);
+    std::vector<double> pc(n, 0.0);
+    double sigma = 0.3;
+    uint64_t state = params.Engine.Seed;
+    std::vector<std::vector<double>> samples(lambda, std::vector<double>(n));
+    std::vector<std::vector<double>> steps(lambda, std::vector<double>(n));
+    std::vector<Candidate> candidates(lambda);
+    std::vector<int> order(lambda);
+    for (int generation = 0; generation < params.Generations; generation++)
+    {
+        for (int i = 0; i < lambda; i++)
+        {
+            candidates[i].Values.clear();
+            for (int j = 0; j < n; j++)
+            {
+                steps[i][j] = GetNormal(state);
+                samples[i][j] = mean[j] + sigma * std::sqrt(variance[j]) * steps[i][j];
+                candidates[i].Values.push_back(GetValue(dimensions[j], samples[i][j]));
+            }
+        }
+        Evaluate(evaluator, candidates, dimensions, matches, generation);
+        for (int i = 0; i < lambda; i++)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b)
+        {
+            return candidates[a].Fitness > candidates[b].Fitness;
+        });
+        std::vector<double> previous = mean;
+        for (int j = 0; j < n; j++)
+        {
+            mean[j] = 0.0;
+            for (int i = 0; i < mu; i++)
+            {
+                mean[j] += weights[i] * samples[order[i]][j];
+            }
+        }
+        double norm = 0.0;
+        for (int j = 0; j < n; j++)
+        {
+            double shift = (mean[j] - previous[j]) / sigma;
+            ps[j] = (1.0 - cs) * ps[j] + std::sqrt(cs * (2.0 - cs) * mueff) * shift / std::sqrt(variance[j]);
+            norm += ps[j] * ps[j];
+        }
+        norm = std::sqrt(norm);
+        // h_sigma, 0 while the step size path is too long so the rank one update is held back
+        double hsig = norm / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (generation + 1))) < (1.4 + 2.0 / (n + 1.0)) * chi;
+        for (int j = 0; j < n; j++)
+        {
+            double shift = (mean[j] - previous[j]) / sigma;
+            pc[j] = (1.0 - cc) * pc[j] + hsig * std::sqrt(cc * (2.0 - cc) * mueff) * shift;
+            double rank = 0.0;
+            for (int i = 0; i < mu; i++)
+            {
+                double step = (samples[order[i]][j] - previous[j]) / sigma;
+                rank += weights[i] * step * step;
+            }
+            // with hsig off the path misses its usual share, so that share of variance is kept instead
+            variance[j] = (1.0 - c1 - cmu) * variance[j] + c1 * (pc[j] * pc[j] + (1.0 - hsig) * cc * (2.0 - cc) * variance[j]) +
+                cmu * rank;
+        }
+        sigma = std::min(sigma * std::exp(cs / ds * (norm / chi - 1.0)), 1.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    SweepParams params;
+    if (!GetParams(argc, argv, params))
+    {
+        return 1;
+    }
+    std::vector<Dimension> dimensions;
+    if (!GetDimensions(params, dimensions))
+    {
+        return 1;
+    }
+    // slot 0 is always the tuned robot and every candidate plays the same schedule, so differences
+    // in fitness come from the parameters rather than the draw
+    std::vector<Match> matches = CreateSchedule(params.Opponents.size(), params.Players - 1, params.Matches, params.Engine.Seed);
+    for (Match& match : matches)
+    {
+        for (int& robot : match.Lineup)
+        {
+            robot++;
+        }
+        match.Lineup.insert(match.Lineup.begin(), 0);
+    }
+    params.Engine.Robots = {params.Robot};
+    params.Engine.Robots.insert(params.Engine.Robots.end(), params.Opponents.begin(), params.Opponents.end());
+    Evaluator evaluator;
+    if (!evaluator.Init(params.Engine, params.Threads))
+    {
+        SDL_Log("Failed to initialize evaluator");
+        return 1;
+    }
+    PrintHeader(dimensions);
+    switch (params.Search)
+    {
+    case Strategy::Grid:
+        SearchGrid(params, evaluator, dimensions, matches);
+        break;
+    case Strategy::Random:
+        SearchRandom(params, evaluator, dimensions, matches);
+        break;
+    case Strategy::Evolution:
+        SearchEvolution(params, evaluator, dimensions, matches);
+        break;
+    }
+    evaluator.Destroy();
+    ModuleRegistry::Unload();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <SDL3/SDL.h>
+
+#include <cstdint>
+#include <string>
+
+#include "engine.hpp"
+#include "module.hpp"
+#include "network.hpp"
+#include "session.hpp"
+
+static constexpr int kRetries = 50;
+static constexpr uint64_t kRetryDelay = 100000000;
+
+static bool GetParams(int argc, char** argv, std::string& address)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string outer = argv[i];
+        if (i + 1 == argc)
+        {
+            SDL_Log("Missing value: %s", outer.data());
+            return false;
+        }
+        std::string inner = argv[++i];
+        if (outer == "--connect")
+        {
+            address = inner;
+        }
+        else
+        {
+            SDL_Log("Unknown argument: %s", outer.data());
+            return false;
+        }
+    }
+    if (address.empty())
+    {
+        SDL_Log("Must have an address to connect to");
+        return false;
+    }
+    return true;
+}
+
+static bool Connect(Connection& connection, const std::string& address)
+{
+    // workers are often started alongside the coordinator, so give it a moment to listen
+    for (int i = 0; i < kRetries; i++)
+    {
+        if (connection.Connect(address))
+        {
+            return true;
+        }
+        SDL_DelayNS(kRetryDelay);
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    std::string address;
+    if (!GetParams(argc, argv, address))
+    {
+        return 1;
+    }
+    Connection connection;
+    if (!Connect(connection, address))
+    {
+        SDL_Log("Failed to connect: %s", address.data());
+        return 1;
+    }
+    Engine engine;
+    EngineParams params;
+    bool initialized = false;
+    int status = RunSession(connection, engine, params, initialized) ? 0 : 1;
+    if (initialized)
+    {
+        engine.Destroy();
+    }
+    connection.Close();
+    ModuleRegistry::Unload();
+    return status;
+}
\ No newline at end of file
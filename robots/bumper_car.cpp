@@ -3,10 +3,26 @@
 class Robot : public crobots::IRobot
 {
 public:
+    Robot()
+        : Speed{0.0f}
+        , Started{false}
+    {
+    }
+
     void Update(float deltaTime) override
     {
-        SetSpeed(10.0f);
+        // parameters are looked up by name, so once rather than every tick
+        if (!Started)
+        {
+            Speed = GetParameter("speed", 10.0f, 0.0f, 20.0f);
+            Started = true;
+        }
+        SetSpeed(Speed);
     }
+
+private:
+    float Speed;
+    bool Started;
 };
 
 CROBOTS_ROBOT(Robot)
\ No newline at end of file
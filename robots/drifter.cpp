@@ -0,0 +1,24 @@
+#include <crobots++/abi.hpp>
+
+class Robot : public crobots::AbiRobot
+{
+public:
+    Robot()
+        : Speed{-1.0f}
+    {
+    }
+
+    void Update(float deltaTime) override
+    {
+        if (Speed < 0.0f)
+        {
+            Speed = GetParameter("speed", 8.0f, 0.0f, 20.0f);
+        }
+        SetSpeed(Speed);
+    }
+
+private:
+    float Speed;
+};
+
+CROBOTS_ABI_ROBOT(Robot)
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <crobots++/robot.hpp>
+
+class Robot : public crobots::CoRobot
+{
+public:
+    crobots::Task Run() override
+    {
+        float speed = GetParameter("speed", 5.0f, 0.0f, 20.0f);
+        int ticks = GetParameter("ticks", 60.0f, 1.0f, 600.0f);
+        while (true)
+        {
+            co_await Shuttle(speed, ticks);
+            co_await Shuttle(-speed, ticks);
+        }
+    }
+
+private:
+    crobots::Task Shuttle(float speed, int ticks)
+    {
+        co_await Drive(speed);
+        co_await Wait(ticks);
+        co_await Drive(0.0f);
+        co_await Wait(ticks / 2);
+    }
+};
+
+CROBOTS_ROBOT(Robot)
\ No newline at end of file